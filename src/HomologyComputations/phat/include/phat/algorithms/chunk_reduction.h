@@ -22,55 +22,88 @@
 #include "../boundary_matrix.h"
 
 namespace phat {
+    // Chunks and blocks of global columns are reduced as OpenMP tasks, so idle threads pick up the remaining
+    // work on skewed inputs. There are many more chunks than threads, and the number of threads is never changed.
     class chunk_reduction {
     public:
         enum column_type { GLOBAL
                          , LOCAL_POSITIVE
                          , LOCAL_NEGATIVE };
 
+    protected:
+        enum { min_nr_chunks = 64 };
+        enum { chunks_per_thread = 8 };
+
+        // number of global columns handled by a single task
+        enum { block_size = 256 };
+
     public:
         template< typename Representation >
         void operator() ( boundary_matrix< Representation >& boundary_matrix ) {
+            ( *this )( boundary_matrix, std::vector< index >() );
+        }
 
+        // 'apparent_births' is empty, or as computed by clear_apparent_pairs (see helpers/apparent_pairs.h): the apparent
+        // pairs are taken as local pairs right away, their birth columns have to be cleared
+        template< typename Representation >
+        void operator() ( boundary_matrix< Representation >& boundary_matrix, const std::vector< index >& apparent_births ) {
 
             const index nr_columns = boundary_matrix.get_num_cols();
-            if( omp_get_max_threads( ) > nr_columns )
-                omp_set_num_threads( 1 );
-                
             const dimension max_dim = boundary_matrix.get_max_dim();
 
             std::vector< index > lowest_one_lookup( nr_columns, -1 );
             std::vector < column_type > column_type( nr_columns, GLOBAL );
             std::vector< char > is_active( nr_columns, false );
+            for( index cur_col = 0; cur_col < (index)apparent_births.size(); cur_col++ ) {
+                if( apparent_births[ cur_col ] != -1 ) {
+                    lowest_one_lookup[ apparent_births[ cur_col ] ] = cur_col;
+                    column_type[ cur_col ] = LOCAL_NEGATIVE;
+                    column_type[ apparent_births[ cur_col ] ] = LOCAL_POSITIVE;
+                }
+            }
 
-            const index chunk_size = omp_get_max_threads() == 1 ? (index)sqrt( (double)nr_columns ) : nr_columns / omp_get_max_threads();
+            // enough chunks to keep all threads busy, but not so many that most pairs stop being local
+            const index nr_chunks_wanted = std::max( (index)min_nr_chunks, (index)chunks_per_thread * omp_get_max_threads() );
+            const index chunk_size = std::max( ( nr_columns + nr_chunks_wanted - 1 ) / nr_chunks_wanted, (index)1 );
 
             std::vector< index > chunk_boundaries;
             for( index cur_boundary = 0; cur_boundary < nr_columns; cur_boundary += chunk_size )
                 chunk_boundaries.push_back( cur_boundary );
             chunk_boundaries.push_back( nr_columns );
+            const index nr_chunks = (index)chunk_boundaries.size() - 1;
 
             for( dimension cur_dim = max_dim; cur_dim >= 1; cur_dim-- ) {
                 // Phase 1: Reduce chunks locally -- 1st pass
-                #pragma omp parallel for schedule( guided, 1 )
-                for( index chunk_id = 0; chunk_id < (index)chunk_boundaries.size() - 1; chunk_id++ )
+                #pragma omp parallel
+                #pragma omp single
+                for( index chunk_id = 0; chunk_id < nr_chunks; chunk_id++ ) {
+                    #pragma omp task
                     _local_chunk_reduction( boundary_matrix, lowest_one_lookup, column_type, cur_dim,
                                             chunk_boundaries[ chunk_id ], chunk_boundaries[ chunk_id + 1 ], chunk_boundaries[ chunk_id ] );
+                }
                 boundary_matrix.sync();
 
                 // Phase 1: Reduce chunks locally -- 2nd pass
-                #pragma omp parallel for schedule( guided, 1 )
-                for( index chunk_id = 1; chunk_id < (index)chunk_boundaries.size( ) - 1; chunk_id++ )
+                #pragma omp parallel
+                #pragma omp single
+                for( index chunk_id = 1; chunk_id < nr_chunks; chunk_id++ ) {
+                    #pragma omp task
                     _local_chunk_reduction( boundary_matrix, lowest_one_lookup, column_type, cur_dim,
                                             chunk_boundaries[ chunk_id ], chunk_boundaries[ chunk_id + 1 ], chunk_boundaries[ chunk_id - 1 ] );
+                }
                 boundary_matrix.sync( );
             }
 
-            // get global columns
+            // get global columns, grouped by dimension
             std::vector< index > global_columns;
-            for( index cur_col_idx = 0; cur_col_idx < nr_columns; cur_col_idx++ )
-                if( column_type[ cur_col_idx ] == GLOBAL )
-                    global_columns.push_back( cur_col_idx );
+            std::vector< index > global_dim_offsets( max_dim + 2, 0 );
+            for( dimension cur_dim = 0; cur_dim <= max_dim; cur_dim++ ) {
+                const index* dim_cols = boundary_matrix.get_cols_of_dim( cur_dim );
+                for( index idx = 0; idx < boundary_matrix.get_num_cols_of_dim( cur_dim ); idx++ )
+                    if( column_type[ dim_cols[ idx ] ] == GLOBAL )
+                        global_columns.push_back( dim_cols[ idx ] );
+                global_dim_offsets[ cur_dim + 1 ] = (index)global_columns.size();
+            }
 
             // get active columns
             #pragma omp parallel for
@@ -81,17 +114,23 @@ namespace phat {
             // Phase 2+3: Simplify columns and reduce them
             for( dimension cur_dim = max_dim; cur_dim >= 1; cur_dim-- ) {
                 // Phase 2: Simplify columns 
-                std::vector< index > temp_col;
-                #pragma omp parallel for schedule( guided, 1 ), private( temp_col )
-                for( index idx = 0; idx < (index)global_columns.size(); idx++ )
-                    if( boundary_matrix.get_dim( global_columns[ idx ] ) == cur_dim )
-                        _global_column_simplification( global_columns[ idx ], boundary_matrix, lowest_one_lookup, column_type, is_active, temp_col );
+                #pragma omp parallel
+                #pragma omp single
+                for( index block_begin = global_dim_offsets[ cur_dim ]; block_begin < global_dim_offsets[ cur_dim + 1 ]; block_begin += block_size ) {
+                    #pragma omp task
+                    {
+                        const index block_end = std::min( block_begin + (index)block_size, global_dim_offsets[ cur_dim + 1 ] );
+                        std::vector< index > temp_col;
+                        for( index idx = block_begin; idx < block_end; idx++ )
+                            _global_column_simplification( global_columns[ idx ], boundary_matrix, lowest_one_lookup, column_type, is_active, temp_col );
+                    }
+                }
                 boundary_matrix.sync();
 
                 // Phase 3: Reduce columns
-                for( index idx = 0; idx < (index)global_columns.size(); idx++ ) {
+                for( index idx = global_dim_offsets[ cur_dim ]; idx < global_dim_offsets[ cur_dim + 1 ]; idx++ ) {
                     index cur_col = global_columns[ idx ];
-                    if( boundary_matrix.get_dim( cur_col ) == cur_dim && column_type[ cur_col ] == GLOBAL ) {
+                    if( column_type[ cur_col ] == GLOBAL ) {
                         index lowest_one = boundary_matrix.get_max_index( cur_col );
                         while( lowest_one != -1 && lowest_one_lookup[ lowest_one ] != -1 ) {
                             boundary_matrix.add_to( lowest_one_lookup[ lowest_one ], cur_col );
@@ -119,8 +158,13 @@ namespace phat {
                                    , const index chunk_end
                                    , const index row_begin ) {
 
-            for( index cur_col = chunk_begin; cur_col < chunk_end; cur_col++ ) {
-                if( column_type[ cur_col ] == GLOBAL && boundary_matrix.get_dim( cur_col ) == cur_dim ) {
+            // the columns of the current dimension within the chunk
+            const index* dim_cols_begin = boundary_matrix.get_cols_of_dim( cur_dim );
+            const index* dim_cols_end = dim_cols_begin + boundary_matrix.get_num_cols_of_dim( cur_dim );
+            const index* chunk_cols_end = std::lower_bound( dim_cols_begin, dim_cols_end, chunk_end );
+            for( const index* dim_col = std::lower_bound( dim_cols_begin, dim_cols_end, chunk_begin ); dim_col != chunk_cols_end; dim_col++ ) {
+                const index cur_col = *dim_col;
+                if( column_type[ cur_col ] == GLOBAL ) {
                     index lowest_one = boundary_matrix.get_max_index( cur_col );
                     while( lowest_one != -1 && lowest_one >= row_begin && lowest_one_lookup[ lowest_one ] != -1 ) {
                         boundary_matrix.add_to( lowest_one_lookup[ lowest_one ], cur_col );
@@ -147,40 +191,47 @@ namespace phat {
             const index nr_columns = boundary_matrix.get_num_cols();
             std::vector< char > finished( nr_columns, false );
 
-            std::vector< std::pair < index, index > > stack;
-            std::vector< index > cur_col_values;
-            #pragma omp parallel for schedule( guided, 1 ), private( stack, cur_col_values )
-            for( index idx = 0; idx < (index)global_columns.size(); idx++ ) {
-                bool pop_next = false;
-                index start_col = global_columns[ idx ];
-                stack.push_back( std::pair< index, index >( start_col, -1 ) );
-                while( !stack.empty() ) {
-                    index cur_col = stack.back().first;
-                    index prev_col = stack.back().second;
-                    if( pop_next ) {
-                        stack.pop_back();
-                        pop_next = false;
-                        if( prev_col != -1 ) {
-                            if( is_active[ cur_col ] ) {
-                                is_active[ prev_col ] = true;
-                            }
-                            if( prev_col == stack.back().first ) {
-                                finished[ prev_col ] = true;
+            #pragma omp parallel
+            #pragma omp single
+            for( index block_begin = 0; block_begin < (index)global_columns.size(); block_begin += block_size ) {
+                #pragma omp task
+                {
+                    const index block_end = std::min( block_begin + (index)block_size, (index)global_columns.size() );
+                    std::vector< std::pair < index, index > > stack;
+                    std::vector< index > cur_col_values;
+                    for( index idx = block_begin; idx < block_end; idx++ ) {
+                        bool pop_next = false;
+                        index start_col = global_columns[ idx ];
+                        stack.push_back( std::pair< index, index >( start_col, -1 ) );
+                        while( !stack.empty() ) {
+                            index cur_col = stack.back().first;
+                            index prev_col = stack.back().second;
+                            if( pop_next ) {
+                                stack.pop_back();
+                                pop_next = false;
+                                if( prev_col != -1 ) {
+                                    if( is_active[ cur_col ] ) {
+                                        is_active[ prev_col ] = true;
+                                    }
+                                    if( prev_col == stack.back().first ) {
+                                        finished[ prev_col ] = true;
+                                        pop_next = true;
+                                    }
+                                }
+                            } else {
                                 pop_next = true;
-                            }
-                        }
-                    } else {
-                        pop_next = true;
-                        boundary_matrix.get_col( cur_col, cur_col_values );
-                        for( index idx = 0; idx < (index) cur_col_values.size(); idx++ ) {
-                            index cur_row = cur_col_values[ idx ];
-                            if( ( column_type[ cur_row ] == GLOBAL ) ) {
-                                is_active[ cur_col ] = true;
-                            } else if( column_type[ cur_row ] == LOCAL_POSITIVE ) {
-                                index next_col = lowest_one_lookup[ cur_row ];
-                                if( next_col != cur_col && !finished[ cur_col ] ) {
-                                    stack.push_back( std::make_pair( next_col, cur_col ) );
-                                    pop_next = false;
+                                boundary_matrix.get_col( cur_col, cur_col_values );
+                                for( index idx = 0; idx < (index) cur_col_values.size(); idx++ ) {
+                                    index cur_row = cur_col_values[ idx ];
+                                    if( ( column_type[ cur_row ] == GLOBAL ) ) {
+                                        is_active[ cur_col ] = true;
+                                    } else if( column_type[ cur_row ] == LOCAL_POSITIVE ) {
+                                        index next_col = lowest_one_lookup[ cur_row ];
+                                        if( next_col != cur_col && !finished[ cur_col ] ) {
+                                            stack.push_back( std::make_pair( next_col, cur_col ) );
+                                            pop_next = false;
+                                        }
+                                    }
                                 }
                             }
                         }
@@ -0,0 +1,108 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "../helpers/misc.h"
+#include "../helpers/symmetric_difference.h"
+#include "../boundary_matrix.h"
+
+namespace phat {
+
+    // Twist reduction of the coboundary matrix, i.e., the same computation as twist_reduction on the dualized
+    // matrix, without building the dual matrix. The cofacets of all cells are collected in one compressed
+    // transpose of the boundary matrix (see helpers/compressed_columns.h). Cells are reduced by increasing dimension and decreasing index;
+    // the pivot of a coboundary is its smallest cofacet, and a cell that becomes a pivot is cleared. Only
+    // coboundaries that were modified by an addition are stored.
+    // The boundary matrix only encodes the pairing afterwards: column 'death' contains just 'birth', all other
+    // columns are empty. This is all that compute_persistence_pairs needs.
+    class cohomology_reduction {
+    public:
+        template< typename Representation >
+        void operator() ( boundary_matrix< Representation >& boundary_matrix ) {
+
+            const index nr_columns = boundary_matrix.get_num_cols();
+
+            // cofacets of each cell in increasing order
+            std::vector< index > cofacet_offsets, cofacets;
+            boundary_matrix.sync();
+            compute_compressed_transpose( boundary_matrix, cofacet_offsets, cofacets );
+
+            std::vector< index > pivot_owner( nr_columns, -1 );
+            std::vector< char > is_cleared( nr_columns, false );
+
+            // modified coboundaries: the length followed by the entries, at 'reduced_offsets' of the cell
+            std::vector< index > reduced_offsets( nr_columns, -1 );
+            std::vector< index > reduced_entries;
+
+            column working_col, sum_col;
+            const dimension max_dim = boundary_matrix.get_max_dim();
+            for( dimension cur_dim = 0; cur_dim < max_dim; cur_dim++ ) {
+                const index* dim_cols = boundary_matrix.get_cols_of_dim( cur_dim );
+                for( index idx = boundary_matrix.get_num_cols_of_dim( cur_dim ) - 1; idx >= 0; idx-- ) {
+                    const index cur_col = dim_cols[ idx ];
+                    if( is_cleared[ cur_col ] )
+                        continue;
+
+                    const index* col_begin = cofacets.data() + cofacet_offsets[ cur_col ];
+                    const index* col_end = cofacets.data() + cofacet_offsets[ cur_col + 1 ];
+                    bool is_modified = false;
+                    while( col_begin != col_end && pivot_owner[ *col_begin ] != -1 ) {
+                        const index owner = pivot_owner[ *col_begin ];
+                        const index* owner_begin;
+                        const index* owner_end;
+                        if( reduced_offsets[ owner ] == -1 ) {
+                            owner_begin = cofacets.data() + cofacet_offsets[ owner ];
+                            owner_end = cofacets.data() + cofacet_offsets[ owner + 1 ];
+                        } else {
+                            owner_begin = reduced_entries.data() + reduced_offsets[ owner ] + 1;
+                            owner_end = owner_begin + reduced_entries[ reduced_offsets[ owner ] ];
+                        }
+                        sum_col.resize( ( col_end - col_begin ) + ( owner_end - owner_begin ) );
+                        index* sum_end = symmetric_difference( col_begin, col_end, owner_begin, owner_end, sum_col.data() );
+                        sum_col.resize( sum_end - sum_col.data() );
+                        working_col.swap( sum_col );
+                        col_begin = working_col.data();
+                        col_end = col_begin + working_col.size();
+                        is_modified = true;
+                    }
+
+                    if( col_begin != col_end ) {
+                        pivot_owner[ *col_begin ] = cur_col;
+                        is_cleared[ *col_begin ] = true;
+                        if( is_modified ) {
+                            reduced_offsets[ cur_col ] = (index)reduced_entries.size();
+                            reduced_entries.push_back( col_end - col_begin );
+                            reduced_entries.insert( reduced_entries.end(), col_begin, col_end );
+                        }
+                    }
+                }
+            }
+
+            // keep only the pairing in the boundary matrix
+            column temp_col;
+            #pragma omp parallel for private( temp_col )
+            for( index cur_col = 0; cur_col < nr_columns; cur_col++ ) {
+                if( pivot_owner[ cur_col ] == -1 ) {
+                    boundary_matrix.clear( cur_col );
+                } else {
+                    temp_col.assign( 1, pivot_owner[ cur_col ] );
+                    boundary_matrix.set_col( cur_col, temp_col );
+                }
+            }
+            boundary_matrix.sync();
+        }
+    };
+}
@@ -0,0 +1,91 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "../helpers/misc.h"
+#include "../boundary_matrix.h"
+
+namespace phat {
+
+    // Twist reduction where all columns of one dimension are reduced concurrently.
+    // A column claims its lowest one with a compare-and-swap on the pivot table. Only columns to the left
+    // may be added, so a column that finds a larger owner in the table takes the pivot over; the evicted
+    // column is reduced again in the next round. A column is finalized before it is published in the table,
+    // so its entries are never modified while other threads may read them. The smallest column of a round
+    // never loses, hence every round makes progress, and with a single thread there is only one round.
+    class parallel_twist_reduction {
+    public:
+        template< typename Representation >
+        void operator () ( boundary_matrix< Representation >& boundary_matrix ) {
+
+            const index nr_columns = boundary_matrix.get_num_cols();
+            std::vector< std::atomic< index > > lowest_one_lookup( nr_columns );
+            #pragma omp parallel for
+            for( index idx = 0; idx < nr_columns; idx++ )
+                lowest_one_lookup[ idx ].store( -1, std::memory_order_relaxed );
+
+            thread_local_storage< std::vector< index > > evicted_columns;
+
+            for( dimension cur_dim = boundary_matrix.get_max_dim(); cur_dim >= 1 ; cur_dim-- ) {
+                const index* dim_cols = boundary_matrix.get_cols_of_dim( cur_dim );
+                std::vector< index > cur_columns( dim_cols, dim_cols + boundary_matrix.get_num_cols_of_dim( cur_dim ) );
+
+                while( !cur_columns.empty() ) {
+                    #pragma omp parallel for schedule( dynamic, 64 )
+                    for( index idx = 0; idx < (index)cur_columns.size(); idx++ )
+                        _reduce_column( boundary_matrix, lowest_one_lookup, cur_columns[ idx ], evicted_columns() );
+                    boundary_matrix.sync();
+
+                    cur_columns.clear();
+                    for( int tid = 0; tid < omp_get_max_threads(); tid++ ) {
+                        cur_columns.insert( cur_columns.end(), evicted_columns[ tid ].begin(), evicted_columns[ tid ].end() );
+                        evicted_columns[ tid ].clear();
+                    }
+                    std::sort( cur_columns.begin(), cur_columns.end() );
+                }
+            }
+        }
+
+    protected:
+        template< typename Representation >
+        void _reduce_column( boundary_matrix< Representation >& boundary_matrix
+                           , std::vector< std::atomic< index > >& lowest_one_lookup
+                           , const index cur_col
+                           , std::vector< index >& evicted_columns ) {
+
+            index lowest_one = boundary_matrix.get_max_index( cur_col );
+            while( lowest_one != -1 ) {
+                index owner = lowest_one_lookup[ lowest_one ].load( std::memory_order_acquire );
+                if( owner != -1 && owner < cur_col ) {
+                    boundary_matrix.add_to( owner, cur_col );
+                    lowest_one = boundary_matrix.get_max_index( cur_col );
+                    continue;
+                }
+
+                boundary_matrix.finalize( cur_col );
+                // on a lost race 'owner' is updated to the new entry and the column is looked at again
+                if( lowest_one_lookup[ lowest_one ].compare_exchange_strong( owner, cur_col, std::memory_order_acq_rel ) ) {
+                    if( owner == -1 )
+                        boundary_matrix.clear( lowest_one );
+                    else
+                        evicted_columns.push_back( owner );
+                    return;
+                }
+            }
+            boundary_matrix.finalize( cur_col );
+        }
+    };
+}
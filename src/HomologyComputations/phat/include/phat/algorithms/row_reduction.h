@@ -26,28 +26,59 @@ namespace phat {
     public:
         template< typename Representation >
         void operator() ( boundary_matrix< Representation >& boundary_matrix ) {
+            ( *this )( boundary_matrix, std::vector< index >() );
+        }
+
+        // 'apparent_births' is empty, or as computed by clear_apparent_pairs (see helpers/apparent_pairs.h): the apparent
+        // pairs are taken as given pivots, their birth columns have to be cleared and their death columns are skipped
+        template< typename Representation >
+        void operator() ( boundary_matrix< Representation >& boundary_matrix, const std::vector< index >& apparent_births ) {
             
             const index nr_columns = boundary_matrix.get_num_cols();
-            std::vector< std::vector< index > > lowest_one_lookup( nr_columns );
+
+            // the death of the apparent pair of each birth -- the first column containing it, so always the source
+            std::vector< index > apparent_deaths;
+            if( !apparent_births.empty() ) {
+                apparent_deaths.assign( nr_columns, -1 );
+                for( index cur_col = 0; cur_col < nr_columns; cur_col++ )
+                    if( apparent_births[ cur_col ] != -1 )
+                        apparent_deaths[ apparent_births[ cur_col ] ] = cur_col;
+            }
+
+            // the columns with a given lowest one as singly linked lists -- every column is in at most one
+            // list whose row has not been processed yet, so a single 'next' link per column suffices
+            std::vector< index > first_with_lowest_one( nr_columns, -1 );
+            std::vector< index > next_with_same_lowest_one( nr_columns, -1 );
             
             for( index cur_col = nr_columns - 1; cur_col >= 0; cur_col-- ) {
-                if( !boundary_matrix.is_empty( cur_col ) )
-                    lowest_one_lookup[ boundary_matrix.get_max_index( cur_col ) ].push_back( cur_col );
+                if( !boundary_matrix.is_empty( cur_col ) && ( apparent_births.empty() || apparent_births[ cur_col ] == -1 ) ) {
+                    const index lowest_one = boundary_matrix.get_max_index( cur_col );
+                    next_with_same_lowest_one[ cur_col ] = first_with_lowest_one[ lowest_one ];
+                    first_with_lowest_one[ lowest_one ] = cur_col;
+                }
                 
-                if( !lowest_one_lookup[ cur_col ].empty() ) {
+                const index apparent_death = apparent_deaths.empty() ? -1 : apparent_deaths[ cur_col ];
+                if( first_with_lowest_one[ cur_col ] != -1 ) {
                     boundary_matrix.clear( cur_col );
                     boundary_matrix.finalize( cur_col );
-                    std::vector< index >& cols_with_cur_lowest = lowest_one_lookup[ cur_col ];
-                    index source = *min_element( cols_with_cur_lowest.begin(), cols_with_cur_lowest.end() );
-                    for( index idx = 0; idx < (index)cols_with_cur_lowest.size(); idx++ ) {
-                        index target = cols_with_cur_lowest[ idx ];
+                    index source = first_with_lowest_one[ cur_col ];
+                    if( apparent_death != -1 )
+                        source = apparent_death;
+                    else
+                        for( index target = source; target != -1; target = next_with_same_lowest_one[ target ] )
+                            source = std::min( source, target );
+                    index target = first_with_lowest_one[ cur_col ];
+                    while( target != -1 ) {
+                        const index next_target = next_with_same_lowest_one[ target ];
                         if( target != source && !boundary_matrix.is_empty( target ) ) {
                             boundary_matrix.add_to( source, target );     
                             if( !boundary_matrix.is_empty( target ) ) {
                                 index lowest_one_of_target = boundary_matrix.get_max_index( target );
-                                lowest_one_lookup[ lowest_one_of_target ].push_back( target );
+                                next_with_same_lowest_one[ target ] = first_with_lowest_one[ lowest_one_of_target ];
+                                first_with_lowest_one[ lowest_one_of_target ] = target;
                             }
                         } 
+                        target = next_target;
                     }
                 }
             }
@@ -38,14 +38,17 @@ namespace phat {
             std::vector< std::vector< index > > unreduced_cols_cur_pass( num_stripes );
             std::vector< std::vector< index > > unreduced_cols_next_pass( num_stripes );
             
-            for( index cur_dim = boundary_matrix.get_max_dim(); cur_dim >= 1 ; cur_dim-- ) {
+            for( dimension cur_dim = boundary_matrix.get_max_dim(); cur_dim >= 1 ; cur_dim-- ) {
+                const index* dim_cols_begin = boundary_matrix.get_cols_of_dim( cur_dim );
+                const index* dim_cols_end = dim_cols_begin + boundary_matrix.get_num_cols_of_dim( cur_dim );
                 #pragma omp parallel for schedule( guided, 1 )
                 for( index cur_stripe = 0; cur_stripe < num_stripes; cur_stripe++ ) {
                     index col_begin = cur_stripe * block_size;
                     index col_end = std::min( (cur_stripe+1) * block_size, nr_columns );
-                    for( index cur_col = col_begin; cur_col < col_end; cur_col++ )
-                        if( boundary_matrix.get_dim( cur_col ) == cur_dim && boundary_matrix.get_max_index( cur_col ) != -1 )
-                            unreduced_cols_cur_pass[ cur_stripe ].push_back( cur_col );
+                    const index* dim_cols_stripe_end = std::lower_bound( dim_cols_begin, dim_cols_end, col_end );
+                    for( const index* dim_col = std::lower_bound( dim_cols_begin, dim_cols_end, col_begin ); dim_col != dim_cols_stripe_end; dim_col++ )
+                        if( boundary_matrix.get_max_index( *dim_col ) != -1 )
+                            unreduced_cols_cur_pass[ cur_stripe ].push_back( *dim_col );
                 }
                 for( index cur_pass = 0; cur_pass < num_stripes; cur_pass++ ) {
                     boundary_matrix.sync();
@@ -20,26 +20,50 @@
 
 #include "../helpers/misc.h"
 #include "../boundary_matrix.h"
+#include "../transform_matrix.h"
 
 namespace phat {
     class standard_reduction {
     public:
         template< typename Representation >
         void operator() ( boundary_matrix< Representation >& boundary_matrix ) {
+            untracked_transform transform;
+            ( *this )( boundary_matrix, transform );
+        }
+
+        // also reports all column operations to 'transform', e.g. a transform_matrix (see transform_matrix.h)
+        template< typename Representation, typename Transform >
+        void operator() ( boundary_matrix< Representation >& boundary_matrix, Transform& transform ) {
+            ( *this )( boundary_matrix, transform, std::vector< index >() );
+        }
+
+        // 'apparent_births' is empty, or as computed by clear_apparent_pairs (see helpers/apparent_pairs.h): the apparent
+        // pairs are taken as given pivots, their birth columns have to be cleared and their death columns are skipped.
+        // A transform_matrix does not see the cleared birth columns, so it needs an empty 'apparent_births'.
+        template< typename Representation, typename Transform >
+        void operator() ( boundary_matrix< Representation >& boundary_matrix, Transform& transform, const std::vector< index >& apparent_births ) {
 
             const index nr_columns = boundary_matrix.get_num_cols();
             std::vector< index > lowest_one_lookup( nr_columns, -1 );
+            transform.init( nr_columns );
+            for( index cur_col = 0; cur_col < (index)apparent_births.size(); cur_col++ )
+                if( apparent_births[ cur_col ] != -1 )
+                    lowest_one_lookup[ apparent_births[ cur_col ] ] = cur_col;
 
             for( index cur_col = 0; cur_col < nr_columns; cur_col++ ) {
+                if( !apparent_births.empty() && apparent_births[ cur_col ] != -1 )
+                    continue;
                 index lowest_one = boundary_matrix.get_max_index( cur_col );
                 while( lowest_one != -1 && lowest_one_lookup[ lowest_one ] != -1 ) {
                     boundary_matrix.add_to( lowest_one_lookup[ lowest_one ], cur_col );
+                    transform.add_to( lowest_one_lookup[ lowest_one ], cur_col );
                     lowest_one = boundary_matrix.get_max_index( cur_col );
                 }
                 if( lowest_one != -1 ) {
                     lowest_one_lookup[ lowest_one ] = cur_col;
                 }
                 boundary_matrix.finalize( cur_col );
+                transform.finalize( cur_col );
             }
         }
     };
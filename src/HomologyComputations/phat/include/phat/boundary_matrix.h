@@ -19,6 +19,9 @@
 #pragma once
 
 #include "helpers/misc.h"
+#include "helpers/mapped_file.h"
+#include "helpers/compact_format.h"
+#include "helpers/compressed_columns.h"
 #include "representations/bit_tree_pivot_column.h"
 
 // interface class for the main data structure -- implementations of the interface can be found in ./representations
@@ -30,19 +33,47 @@ namespace phat {
     protected:
         Representation rep;
 
+        // the columns grouped by dimension, built on demand and invalidated by set_num_cols and set_dim:
+        // the columns of dimension d are dim_columns[ dim_offsets[ d ] ], ..., dim_columns[ dim_offsets[ d + 1 ] - 1 ]
+        // (columns of negative dimension are left out)
+        mutable std::vector< index > dim_offsets;
+        mutable std::vector< index > dim_columns;
+        mutable bool is_dim_index_valid;
+
+        void build_dim_index() const {
+            if( is_dim_index_valid )
+                return;
+            const index nr_of_columns = get_num_cols();
+            dimension max_dim = 0;
+            for( index idx = 0; idx < nr_of_columns; idx++ )
+                max_dim = std::max( max_dim, get_dim( idx ) );
+            dim_offsets.assign( max_dim + 2, 0 );
+            for( index idx = 0; idx < nr_of_columns; idx++ )
+                if( get_dim( idx ) >= 0 )
+                    dim_offsets[ get_dim( idx ) + 1 ]++;
+            for( dimension dim = 0; dim <= max_dim; dim++ )
+                dim_offsets[ dim + 1 ] += dim_offsets[ dim ];
+            dim_columns.resize( dim_offsets[ max_dim + 1 ] );
+            std::vector< index > next_position( dim_offsets.begin(), dim_offsets.end() - 1 );
+            for( index idx = 0; idx < nr_of_columns; idx++ )
+                if( get_dim( idx ) >= 0 )
+                    dim_columns[ next_position[ get_dim( idx ) ]++ ] = idx;
+            is_dim_index_valid = true;
+        }
+
     // interface functions -- actual implementation and complexity depends on chosen @Representation template
     public:
         // get overall number of columns in boundary_matrix
         index get_num_cols() const { return rep._get_num_cols(); }
 
         // set overall number of columns in boundary_matrix
-        void set_num_cols( index nr_of_columns ) { rep._set_num_cols( nr_of_columns ); }
+        void set_num_cols( index nr_of_columns ) { rep._set_num_cols( nr_of_columns ); is_dim_index_valid = false; }
 
         // get dimension of given index
         dimension get_dim( index idx ) const { return rep._get_dim( idx ); }
 
         // set dimension of given index
-        void set_dim( index idx, dimension dim ) { rep._set_dim( idx, dim ); }
+        void set_dim( index idx, dimension dim ) { rep._set_dim( idx, dim ); is_dim_index_valid = false; }
 
         // replaces content of @col with boundary of given index
         void get_col( index idx, column& col  ) const { col.clear(); rep._get_col( idx, col ); }
@@ -73,12 +104,25 @@ namespace phat {
 
     // info functions -- independent of chosen 'Representation'
     public:
+        // The following three functions build the index of columns by dimension if it is out of date, which
+        // is NOT thread-safe -- afterwards they are cheap and can be called concurrently.
+
         // maximal dimension
         dimension get_max_dim() const {
-            dimension cur_max_dim = 0;
-            for( index idx = 0; idx < get_num_cols(); idx++ )
-                cur_max_dim = get_dim( idx ) > cur_max_dim ? get_dim( idx ) : cur_max_dim;
-            return cur_max_dim;
+            build_dim_index();
+            return (dimension)( dim_offsets.size() - 2 );
+        }
+
+        // number of columns of dimension @dim
+        index get_num_cols_of_dim( dimension dim ) const {
+            build_dim_index();
+            return dim >= 0 && dim < (index)dim_offsets.size() - 1 ? dim_offsets[ dim + 1 ] - dim_offsets[ dim ] : 0;
+        }
+
+        // the get_num_cols_of_dim( @dim ) columns of dimension @dim in increasing order
+        const index* get_cols_of_dim( dimension dim ) const {
+            build_dim_index();
+            return dim_columns.data() + ( dim >= 0 && dim < (index)dim_offsets.size() - 1 ? dim_offsets[ dim ] : 0 );
         }
 
         // number of nonzero rows for given column @idx
@@ -92,42 +136,40 @@ namespace phat {
         index get_max_col_entries() const {
             index max_col_entries = -1;
             const index nr_of_columns = get_num_cols();
-            for( index idx = 0; idx < nr_of_columns; idx++ )
-                max_col_entries = get_num_rows( idx ) > max_col_entries ? get_num_rows( idx ) : max_col_entries;
+            column temp_col;
+            for( index idx = 0; idx < nr_of_columns; idx++ ) {
+                get_col( idx, temp_col );
+                max_col_entries = (index)temp_col.size() > max_col_entries ? (index)temp_col.size() : max_col_entries;
+            }
             return max_col_entries;
         }
 
         // maximal number of nonzero cols of all rows
         index get_max_row_entries() const {
-            size_t max_row_entries = 0;
-            const index nr_of_columns = get_num_cols();
-            std::vector< std::vector< index > > transposed_matrix( nr_of_columns );
-            column temp_col;
-            for( index cur_col = 0; cur_col < nr_of_columns; cur_col++ ) {
-                get_col( cur_col, temp_col );
-                for( index idx = 0; idx < (index)temp_col.size(); idx++)
-                    transposed_matrix[ temp_col[ idx ]  ].push_back( cur_col );
-            }
-            for( index idx = 0; idx < nr_of_columns; idx++ )
-                max_row_entries = transposed_matrix[ idx ].size() > max_row_entries ? transposed_matrix[ idx ].size() : max_row_entries;
-            return max_row_entries;
+            std::vector< index > row_entries;
+            count_row_entries( *this, row_entries );
+            return row_entries.empty() ? 0 : *std::max_element( row_entries.begin(), row_entries.end() );
         }
 
         // overall number of entries in the matrix
         index get_num_entries() const {
             index number_of_nonzero_entries = 0;
             const index nr_of_columns = get_num_cols();
-            for( index idx = 0; idx < nr_of_columns; idx++ )
-                number_of_nonzero_entries += get_num_rows( idx );
+            column temp_col;
+            #pragma omp parallel for private( temp_col ) reduction( + : number_of_nonzero_entries )
+            for( index idx = 0; idx < nr_of_columns; idx++ ) {
+                get_col( idx, temp_col );
+                number_of_nonzero_entries += (index)temp_col.size();
+            }
             return number_of_nonzero_entries;
         }
     
     // operators / constructors
     public:
-        boundary_matrix() {};
+        boundary_matrix() : is_dim_index_valid( false ) {};
 
         template< class OtherRepresentation >
-        boundary_matrix( const boundary_matrix< OtherRepresentation >& other ) {
+        boundary_matrix( const boundary_matrix< OtherRepresentation >& other ) : is_dim_index_valid( false ) {
             *this = other;
         }
 
@@ -179,9 +221,10 @@ namespace phat {
             const index nr_of_columns = (index)input_matrix.size();
             this->set_num_cols( nr_of_columns );
             column temp_col;
+            // set_num_cols invalidated the dimension index, so the threads only write their own columns
             #pragma omp parallel for private( temp_col )
             for( index cur_col = 0; cur_col <  nr_of_columns; cur_col++ ) {
-                this->set_dim( cur_col, (dimension)input_dims[ cur_col ] );
+                rep._set_dim( cur_col, (dimension)input_dims[ cur_col ] );
                 
                 index num_rows = input_matrix[ cur_col ].size();
                 temp_col.resize( num_rows );
@@ -191,6 +234,12 @@ namespace phat {
             }
         }
 
+        // replaces the matrix by the given compressed columns (see helpers/compressed_columns.h) -- the vectors are consumed
+        void load_compressed( std::vector< dimension >& dims, std::vector< index >& offsets, std::vector< index >& entries ) {
+            is_dim_index_valid = false;
+            load_compressed_columns( rep, dims, offsets, entries );
+        }
+
         template< typename index_type, typename dimemsion_type >
         void save_vector_vector( std::vector< std::vector< index_type > >& output_matrix, std::vector< dimemsion_type >& output_dims ) { 
             const index nr_of_columns = get_num_cols();
@@ -212,52 +261,19 @@ namespace phat {
         // Loads the boundary_matrix from given file in ascii format 
         // Format: each line represents a column, first number is dimension, other numbers are the content of the column.
         // Ignores empty lines and lines starting with a '#'.
+        // The file is parsed in parallel; returns false if it contains anything but blanks and non-negative integers.
         bool load_ascii( std::string filename ) { 
-            // first count number of columns:
-            std::string cur_line;
-            std::ifstream dummy( filename .c_str() );
-            if( dummy.fail() )
+            mapped_ascii_matrix input;
+            if( !input.open( filename ) )
                 return false;
 
-            index number_of_columns = 0;
-            while( getline( dummy, cur_line ) ) {
-                cur_line.erase(cur_line.find_last_not_of(" \t\n\r\f\v") + 1);
-                if( cur_line != "" && cur_line[ 0 ] != '#' )
-                    number_of_columns++;
-
-            }
-            this->set_num_cols( number_of_columns );
-            dummy.close();
-
-            std::ifstream input_stream( filename.c_str() );
-            if( input_stream.fail() )
-                return false;
-            
-            column temp_col;
-            index cur_col = -1;
-            while( getline( input_stream, cur_line ) ) {
-                cur_line.erase(cur_line.find_last_not_of(" \t\n\r\f\v") + 1);
-                if( cur_line != "" && cur_line[ 0 ] != '#' ) {
-                    cur_col++;
-                    std::stringstream ss( cur_line );
-                    
-                    int64_t temp_dim;
-                    ss >> temp_dim;
-                    this->set_dim( cur_col, (dimension) temp_dim );
-
-                    int64_t temp_index;
-                    temp_col.clear();
-                    while( ss.good() ) {
-                        ss >> temp_index;
-                        temp_col.push_back( (index)temp_index );
-                    }
-                    std::sort( temp_col.begin(), temp_col.end() );
-                    this->set_col( cur_col, temp_col );
-                }
-            }
+            return load_ascii( input );
+        }
 
-            input_stream.close();
-            return true;
+        // Loads the boundary_matrix from an ascii file that is already mapped, e.g., to look at its number of columns first
+        bool load_ascii( const mapped_ascii_matrix& input ) {
+            is_dim_index_valid = false;
+            return load_mapped_ascii( rep, input );
         }
 
         // Saves the boundary_matrix to given file in ascii format
@@ -283,33 +299,15 @@ namespace phat {
 
         // Loads boundary_matrix from given file 
         // Format: nr_columns % dim1 % N1 % row1 row2 % ...% rowN1 % dim2 % N2 % ...
+        // The file is memory mapped; representations that support it keep reading the columns from the mapping.
         bool load_binary( std::string filename )
         {
-            std::ifstream input_stream( filename.c_str( ), std::ios_base::binary | std::ios_base::in );
-            if( input_stream.fail( ) )
+            std::shared_ptr< mapped_binary_matrix > input( new mapped_binary_matrix );
+            if( !input->open( filename ) )
                 return false;
 
-            int64_t nr_columns;
-            input_stream.read( (char*)&nr_columns, sizeof( int64_t ) );
-            this->set_num_cols( (index)nr_columns );
-
-            column temp_col;
-            for( index cur_col = 0; cur_col < nr_columns; cur_col++ ) {
-                int64_t cur_dim;
-                input_stream.read( (char*)&cur_dim, sizeof( int64_t ) );
-                this->set_dim( cur_col, (dimension)cur_dim );
-                int64_t nr_rows;
-                input_stream.read( (char*)&nr_rows, sizeof( int64_t ) );
-                temp_col.resize( ( std::size_t )nr_rows );
-                for( index idx = 0; idx < nr_rows; idx++ ) {
-                    int64_t cur_row;
-                    input_stream.read( (char*)&cur_row, sizeof( int64_t ) );
-                    temp_col[ idx ] = (index)cur_row;
-                }
-                this->set_col( cur_col, temp_col );
-            }
-
-            input_stream.close( );
+            is_dim_index_valid = false;
+            load_mapped_binary( rep, std::shared_ptr< const mapped_binary_matrix >( input ) );
             return true;
         }
 
@@ -339,5 +337,54 @@ namespace phat {
             output_stream.close( );
             return true;
         }
+
+        // Loads boundary_matrix from given file in compact format (see helpers/compact_format.h)
+        // The blocks of the file are decoded in parallel.
+        bool load_compact( std::string filename )
+        {
+            mapped_compact_file input;
+            if( !input.open( filename, COMPACT_BOUNDARY_MATRIX ) )
+                return false;
+
+            this->set_num_cols( input.get_num_items() );
+            bool is_valid = true;
+            column temp_col;
+            // set_num_cols invalidated the dimension index, so the threads only write their own columns
+            #pragma omp parallel for schedule( dynamic, 1 ) private( temp_col ) reduction( && : is_valid )
+            for( index block_id = 0; block_id < input.get_num_blocks(); block_id++ ) {
+                const unsigned char* pos = input.get_block_begin( block_id );
+                const unsigned char* block_end = input.get_block_end( block_id );
+                for( index cur_col = input.get_first_item( block_id ); is_valid && cur_col < input.get_first_item( block_id + 1 ); cur_col++ ) {
+                    dimension cur_dim;
+                    is_valid = read_compact_column( pos, block_end, cur_col, cur_dim, temp_col );
+                    if( is_valid ) {
+                        rep._set_dim( cur_col, cur_dim );
+                        this->set_col( cur_col, temp_col );
+                    }
+                }
+                if( pos != block_end )
+                    is_valid = false;
+            }
+            return is_valid;
+        }
+
+        // Saves the boundary_matrix to given file in compact format (see helpers/compact_format.h)
+        // The blocks of the file are encoded in parallel.
+        bool save_compact( std::string filename )
+        {
+            const index nr_columns = this->get_num_cols();
+            const index nr_blocks = ( nr_columns + compact_block_size - 1 ) / compact_block_size;
+            std::vector< compact_block > blocks( nr_blocks );
+            column temp_col;
+            #pragma omp parallel for schedule( dynamic, 1 ) private( temp_col )
+            for( index block_id = 0; block_id < nr_blocks; block_id++ ) {
+                const index block_end = std::min( ( block_id + 1 ) * (index)compact_block_size, nr_columns );
+                for( index cur_col = block_id * compact_block_size; cur_col < block_end; cur_col++ ) {
+                    this->get_col( cur_col, temp_col );
+                    append_compact_column( blocks[ block_id ], cur_col, this->get_dim( cur_col ), temp_col );
+                }
+            }
+            return save_compact_file( filename, COMPACT_BOUNDARY_MATRIX, nr_columns, compact_block_size, blocks );
+        }
     };
 }
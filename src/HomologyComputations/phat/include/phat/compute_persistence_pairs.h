@@ -19,7 +19,9 @@
 #pragma once
 
 #include "persistence_pairs.h"
+#include "persistence_diagram.h"
 #include "boundary_matrix.h"
+#include "transform_matrix.h"
 #include "helpers/dualize.h"
 #include "algorithms/twist_reduction.h"
 
@@ -65,37 +67,76 @@ namespace phat {
         }
     }
 
-    // Extracts persistence pairs in separate dimensions; expects a d-dimensional vector of persistent_pairs
+    // Reads all intervals off a reduced boundary matrix in a single sweep from the last column to the first.
+    // All columns that can kill a given cell come after it, so when the sweep reaches an empty column, a bit
+    // vector of the births seen so far tells whether it is essential. 'filtration_values' is null or holds one
+    // value per column. The intervals are ordered by their last column, i.e., the death or the birth of an
+    // essential class.
+    template< typename Representation >
+    void extract_persistence_diagram( persistence_diagram& diagram, const boundary_matrix< Representation >& boundary_matrix,
+                                      const double* filtration_values = 0 ) {
+        const index nr_columns = boundary_matrix.get_num_cols();
+        std::vector< bool > is_birth( nr_columns, false );
+        diagram.clear();
+        // every column ends at most one interval
+        diagram.reserve( nr_columns, filtration_values != 0 );
+        for( index idx = nr_columns - 1; idx >= 0; idx-- ) {
+            if( !boundary_matrix.is_empty( idx ) ) {
+                const index birth = boundary_matrix.get_max_index( idx );
+                is_birth[ birth ] = true;
+                diagram.append_interval( boundary_matrix.get_dim( idx ) - 1, birth, idx, filtration_values );
+            } else if( !is_birth[ idx ] ) {
+                diagram.append_interval( boundary_matrix.get_dim( idx ), idx, -1, filtration_values );
+            }
+        }
+        diagram.reverse();
+    }
+
+    template< typename ReductionAlgorithm, typename Representation >
+    void compute_persistence_diagram( persistence_diagram& diagram, boundary_matrix< Representation >& boundary_matrix,
+                                      const double* filtration_values = 0 ) {
+        ReductionAlgorithm reduce;
+        reduce( boundary_matrix );
+        extract_persistence_diagram( diagram, boundary_matrix, filtration_values );
+    }
+
+    // Extracts persistence pairs in separate dimensions; expects a d-dimensional vector of persistent_pairs.
+    // Essential classes are pairs with death -1 after the finite pairs of their dimension.
     template< typename ReductionAlgorithm, typename Representation >
     void compute_persistence_pairs(std::vector<persistence_pairs>& pairs, boundary_matrix<Representation>& boundary_matrix) {
+        persistence_diagram diagram;
+        compute_persistence_diagram< ReductionAlgorithm >( diagram, boundary_matrix );
+        for( std::vector< persistence_pairs >::iterator it = pairs.begin(); it != pairs.end(); ++it ) { it->clear(); }
+        for( index idx = 0; idx < diagram.get_num_intervals(); idx++ )
+            if( !diagram.is_essential( idx ) )
+                pairs[ diagram.get_dim( idx ) ].append_pair( diagram.get_birth( idx ), diagram.get_death( idx ) );
+        for( index idx = 0; idx < diagram.get_num_intervals(); idx++ )
+            if( diagram.is_essential( idx ) )
+                pairs[ diagram.get_dim( idx ) ].append_pair( diagram.get_birth( idx ), -1 );
+    }
+
+    template< typename ReductionAlgorithm, typename Representation >
+    void compute_persistence_pairs( persistence_pairs& pairs, boundary_matrix< Representation >& boundary_matrix ) {
         ReductionAlgorithm reduce;
-        reduce(boundary_matrix);
-        std::map<int, bool> free;
-        for (std::vector<persistence_pairs>::iterator it = pairs.begin(); it != pairs.end(); ++it) { it->clear(); }
-        for (index idx = 0; idx < boundary_matrix.get_num_cols(); ++idx) {
-            int dimension = boundary_matrix.get_dim(idx);
-            free[idx] = true;
-            if (!boundary_matrix.is_empty(idx)) {
-                index birth = boundary_matrix.get_max_index(idx);
+        reduce( boundary_matrix );
+        pairs.clear();
+        for( index idx = 0; idx < boundary_matrix.get_num_cols(); idx++ ) {
+            if( !boundary_matrix.is_empty( idx ) ) {
+                index birth = boundary_matrix.get_max_index( idx );
                 index death = idx;
-                pairs[dimension-1].append_pair(birth, death);
-                // Cannot be of the form (a, infinity)
-                free[birth] = false;
-                free[death] = false;
-            }
-        }
-        for (std::map<int, bool>::iterator it = free.begin(); it != free.end(); ++it) {
-            if (it->second) {
-                int dimension = boundary_matrix.get_dim(it->first);
-                pairs[dimension].append_pair(it->first, -1);
+                pairs.append_pair( birth, death );
             }
         }
     }
 
+    // Also records the matrix V with R = D V in 'transform', so that representative cycles can be read off
+    // afterwards (see get_representative_cycle). Needs a reduction algorithm that reports its column operations,
+    // i.e. standard_reduction or twist_reduction.
     template< typename ReductionAlgorithm, typename Representation >
-    void compute_persistence_pairs( persistence_pairs& pairs, boundary_matrix< Representation >& boundary_matrix ) {
+    void compute_persistence_pairs( persistence_pairs& pairs, boundary_matrix< Representation >& boundary_matrix, transform_matrix& transform ) {
         ReductionAlgorithm reduce;
-        reduce( boundary_matrix );
+        reduce( boundary_matrix, transform );
+        boundary_matrix.sync();
         pairs.clear();
         for( index idx = 0; idx < boundary_matrix.get_num_cols(); idx++ ) {
             if( !boundary_matrix.is_empty( idx ) ) {
@@ -106,6 +147,21 @@ namespace phat {
         }
     }
     
+    // Only computes the pairs of homology up to dimension 'max_homology_dim', i.e., pairs whose birth has at most this
+    // dimension. Columns of dimension max_homology_dim + 1 are reduced as usual to find the deaths, all columns of
+    // higher dimension are cleared beforehand and never touched by the reduction.
+    template< typename ReductionAlgorithm, typename Representation >
+    void compute_persistence_pairs( persistence_pairs& pairs, boundary_matrix< Representation >& boundary_matrix, dimension max_homology_dim ) {
+        const index nr_columns = boundary_matrix.get_num_cols();
+        boundary_matrix.sync();
+        #pragma omp parallel for
+        for( index idx = 0; idx < nr_columns; idx++ )
+            if( boundary_matrix.get_dim( idx ) > max_homology_dim + 1 )
+                boundary_matrix.clear( idx );
+        boundary_matrix.sync();
+        compute_persistence_pairs< ReductionAlgorithm >( pairs, boundary_matrix );
+    }
+
     template< typename ReductionAlgorithm, typename Representation >
     void compute_persistence_pairs_dualized( persistence_pairs& pairs, boundary_matrix< Representation >& boundary_matrix ) {
 
@@ -0,0 +1,132 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "misc.h"
+#include "../persistence_pairs.h"
+#include "../boundary_matrix.h"
+#include "../transform_matrix.h"
+#include "../algorithms/standard_reduction.h"
+#include "../algorithms/twist_reduction.h"
+#include "../algorithms/row_reduction.h"
+#include "../algorithms/chunk_reduction.h"
+
+// A pair ( birth, death ) is apparent if 'birth' is the lowest one of column 'death' and 'death' is the first
+// column that contains 'birth'. No column before 'death' can then ever have 'birth' as its lowest one, so every
+// reduction algorithm leaves column 'death' as it is, and column 'birth' is reduced to zero.
+namespace phat {
+
+    // apparent_births[ col ] is the birth of the apparent pair with death 'col', or -1.
+    // Returns the number of apparent pairs.
+    template< typename Representation >
+    index find_apparent_pairs( boundary_matrix< Representation >& boundary_matrix, std::vector< index >& apparent_births ) {
+
+        const index nr_columns = boundary_matrix.get_num_cols();
+        boundary_matrix.sync();
+
+        // first column containing each row (nr_columns if there is none), as an atomic minimum over all columns
+        std::vector< std::atomic< index > > first_cofacet( nr_columns );
+        #pragma omp parallel for
+        for( index row = 0; row < nr_columns; row++ )
+            first_cofacet[ row ].store( nr_columns, std::memory_order_relaxed );
+        column temp_col;
+        #pragma omp parallel for schedule( dynamic, 1024 ) private( temp_col )
+        for( index cur_col = 0; cur_col < nr_columns; cur_col++ ) {
+            boundary_matrix.get_col( cur_col, temp_col );
+            for( index idx = 0; idx < (index)temp_col.size(); idx++ ) {
+                std::atomic< index >& first = first_cofacet[ temp_col[ idx ] ];
+                index cur_first = first.load( std::memory_order_relaxed );
+                while( cur_col < cur_first && !first.compare_exchange_weak( cur_first, cur_col, std::memory_order_relaxed ) ) {}
+            }
+        }
+
+        apparent_births.assign( nr_columns, -1 );
+        index nr_apparent_pairs = 0;
+        #pragma omp parallel for reduction( +: nr_apparent_pairs )
+        for( index cur_col = 0; cur_col < nr_columns; cur_col++ ) {
+            const index lowest_one = boundary_matrix.get_max_index( cur_col );
+            if( lowest_one != -1 && first_cofacet[ lowest_one ].load( std::memory_order_relaxed ) == cur_col ) {
+                apparent_births[ cur_col ] = lowest_one;
+                nr_apparent_pairs++;
+            }
+        }
+        return nr_apparent_pairs;
+    }
+
+    // Finds the apparent pairs and clears their birth columns. Returns the number of pairs.
+    template< typename Representation >
+    index clear_apparent_pairs( boundary_matrix< Representation >& boundary_matrix, std::vector< index >& apparent_births ) {
+
+        const index nr_columns = boundary_matrix.get_num_cols();
+        const index nr_apparent_pairs = find_apparent_pairs( boundary_matrix, apparent_births );
+
+        #pragma omp parallel for
+        for( index cur_col = 0; cur_col < nr_columns; cur_col++ )
+            if( apparent_births[ cur_col ] != -1 )
+                boundary_matrix.clear( apparent_births[ cur_col ] );
+        boundary_matrix.sync();
+        return nr_apparent_pairs;
+    }
+
+    // Reduces a matrix whose apparent pairs are cleared. The standard, twist, row and chunk algorithms take the
+    // apparent pairs as given pivots and skip their death columns; all others only skip the cleared birth columns.
+    template< typename ReductionAlgorithm, typename Representation >
+    void reduce_with_apparent_pairs( ReductionAlgorithm& reduce, boundary_matrix< Representation >& boundary_matrix, const std::vector< index >& /*apparent_births*/ ) {
+        reduce( boundary_matrix );
+    }
+
+    template< typename Representation >
+    void reduce_with_apparent_pairs( standard_reduction& reduce, boundary_matrix< Representation >& boundary_matrix, const std::vector< index >& apparent_births ) {
+        untracked_transform transform;
+        reduce( boundary_matrix, transform, apparent_births );
+    }
+
+    template< typename Representation >
+    void reduce_with_apparent_pairs( twist_reduction& reduce, boundary_matrix< Representation >& boundary_matrix, const std::vector< index >& apparent_births ) {
+        untracked_transform transform;
+        reduce( boundary_matrix, transform, apparent_births );
+    }
+
+    template< typename Representation >
+    void reduce_with_apparent_pairs( row_reduction& reduce, boundary_matrix< Representation >& boundary_matrix, const std::vector< index >& apparent_births ) {
+        reduce( boundary_matrix, apparent_births );
+    }
+
+    template< typename Representation >
+    void reduce_with_apparent_pairs( chunk_reduction& reduce, boundary_matrix< Representation >& boundary_matrix, const std::vector< index >& apparent_births ) {
+        reduce( boundary_matrix, apparent_births );
+    }
+
+    // Same result as compute_persistence_pairs, but the apparent pairs are found in parallel beforehand: their births
+    // are cleared, the reduction skips their deaths and the pairs are taken over as they are. Returns their number.
+    template< typename ReductionAlgorithm, typename Representation >
+    index compute_persistence_pairs_with_apparent_pairs( persistence_pairs& pairs, boundary_matrix< Representation >& boundary_matrix ) {
+        std::vector< index > apparent_births;
+        const index nr_apparent_pairs = clear_apparent_pairs( boundary_matrix, apparent_births );
+
+        ReductionAlgorithm reduce;
+        reduce_with_apparent_pairs( reduce, boundary_matrix, apparent_births );
+
+        pairs.clear();
+        for( index idx = 0; idx < boundary_matrix.get_num_cols(); idx++ ) {
+            if( apparent_births[ idx ] != -1 )
+                pairs.append_pair( apparent_births[ idx ], idx );
+            else if( !boundary_matrix.is_empty( idx ) )
+                pairs.append_pair( boundary_matrix.get_max_index( idx ), idx );
+        }
+        return nr_apparent_pairs;
+    }
+}
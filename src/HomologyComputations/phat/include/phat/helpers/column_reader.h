@@ -0,0 +1,103 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "misc.h"
+#include "mapped_file.h"
+
+// Readers that deliver the columns of a boundary matrix file one batch at a time, so that the whole matrix
+// never has to be in memory. Both provide
+//     bool open( const std::string& filename )
+//     bool read_columns( index max_nr_columns, std::vector< dimension >& dims, std::vector< column >& cols )
+// where read_columns returns false on a malformed file and leaves 'cols' empty at the end of the file.
+namespace phat {
+
+    // Format: nr_columns % dim1 % N1 % row1 row2 % ...% rowN1 % dim2 % N2 % ...
+    class binary_column_reader {
+
+    protected:
+        std::ifstream input_stream;
+        int64_t nr_columns;
+        int64_t nr_columns_read;
+        int64_t nr_words_left;  // words of the file not read yet, bounds the row counts in the column headers
+
+    public:
+        binary_column_reader() : nr_columns( 0 ), nr_columns_read( 0 ), nr_words_left( 0 ) {}
+
+        bool open( const std::string& filename ) {
+            nr_columns_read = 0;
+            input_stream.open( filename.c_str(), std::ios_base::binary | std::ios_base::in );
+            if( input_stream.fail() || !input_stream.seekg( 0, std::ios_base::end ) )
+                return false;
+            nr_words_left = (int64_t)input_stream.tellg() / (int64_t)sizeof( int64_t ) - 1;
+            return input_stream.seekg( 0, std::ios_base::beg ) && input_stream.read( (char*)&nr_columns, sizeof( int64_t ) ) && nr_columns >= 0;
+        }
+
+        bool read_columns( index max_nr_columns, std::vector< dimension >& dims, std::vector< column >& cols ) {
+            const index nr_batch_columns = (index)std::min( (int64_t)max_nr_columns, nr_columns - nr_columns_read );
+            dims.resize( nr_batch_columns );
+            cols.resize( nr_batch_columns );
+            for( index idx = 0; idx < nr_batch_columns; idx++ ) {
+                int64_t cur_dim, cur_nr_rows;
+                if( !input_stream.read( (char*)&cur_dim, sizeof( int64_t ) ) || !input_stream.read( (char*)&cur_nr_rows, sizeof( int64_t ) ) )
+                    return false;
+                nr_words_left -= 2;
+                if( cur_nr_rows < 0 || cur_nr_rows > nr_words_left )
+                    return false;
+                nr_words_left -= cur_nr_rows;
+                dims[ idx ] = (dimension)cur_dim;
+                cols[ idx ].resize( (std::size_t)cur_nr_rows );
+                if( cur_nr_rows > 0 && !input_stream.read( (char*)cols[ idx ].data(), cur_nr_rows * sizeof( int64_t ) ) )
+                    return false;
+            }
+            nr_columns_read += nr_batch_columns;
+            return true;
+        }
+    };
+
+    // Format: each line represents a column, first number is dimension, other numbers are the content of the column.
+    // Ignores empty lines and lines starting with a '#'.
+    class ascii_column_reader {
+
+    protected:
+        std::ifstream input_stream;
+        std::string cur_line;
+
+    public:
+        bool open( const std::string& filename ) {
+            input_stream.open( filename.c_str() );
+            return !input_stream.fail();
+        }
+
+        bool read_columns( index max_nr_columns, std::vector< dimension >& dims, std::vector< column >& cols ) {
+            dims.resize( max_nr_columns );
+            cols.resize( max_nr_columns );
+            index nr_batch_columns = 0;
+            while( nr_batch_columns < max_nr_columns && getline( input_stream, cur_line ) ) {
+                const char* pos = cur_line.data();
+                const char* line_end = pos + cur_line.size();
+                if( !mapped_ascii_matrix::is_column( pos, line_end ) )
+                    continue;
+                if( !mapped_ascii_matrix::parse_column( pos, line_end, dims[ nr_batch_columns ], cols[ nr_batch_columns ] ) )
+                    return false;
+                nr_batch_columns++;
+            }
+            dims.resize( nr_batch_columns );
+            cols.resize( nr_batch_columns );
+            return true;
+        }
+    };
+}
@@ -0,0 +1,211 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "misc.h"
+#include "mapped_file.h"
+
+// Compact binary format (version 1) for boundary matrices and persistence pairs.
+// Items (columns or pairs) are grouped into blocks of a fixed number of items, and each block is a sequence
+// of LEB128 varints that can be decoded independently of all others.
+//
+// header: magic "PHATCPCT" % uint32 version % uint32 content % uint64 nr_items % uint64 block_size % uint64 nr_blocks
+// index:  nr_blocks + 1 uint64 byte offsets of the blocks, relative to the end of the index
+// blocks: column 'col' of a boundary matrix: dim % nr_rows % zigzag( col - row1 ) % row2 - row1 - 1 % ... % rowN - rowN-1 - 1
+//         persistence pair: zigzag( birth - birth of the previous pair in the block ) % zigzag( death - birth )
+// All fixed size integers are stored in little-endian byte order.
+namespace phat {
+    enum compact_content_type { COMPACT_BOUNDARY_MATRIX = 1, COMPACT_PERSISTENCE_PAIRS = 2 };
+
+    // number of items per block written by save_compact -- readers take the block size from the header
+    enum { compact_block_size = 4096 };
+
+    typedef std::vector< unsigned char > compact_block;
+
+    inline uint64_t zigzag_encode( int64_t value ) {
+        return ( (uint64_t)value << 1 ) ^ (uint64_t)( value >> 63 );
+    }
+
+    inline int64_t zigzag_decode( uint64_t value ) {
+        return (int64_t)( value >> 1 ) ^ -(int64_t)( value & 1 );
+    }
+
+    inline void append_varint( compact_block& block, uint64_t value ) {
+        while( value >= 0x80 ) {
+            block.push_back( (unsigned char)( value | 0x80 ) );
+            value >>= 7;
+        }
+        block.push_back( (unsigned char)value );
+    }
+
+    // false if the block ends within the varint or the varint does not fit into 64 bits
+    inline bool read_varint( const unsigned char*& pos, const unsigned char* block_end, uint64_t& value ) {
+        value = 0;
+        for( int shift = 0; shift < 64 && pos != block_end; shift += 7 ) {
+            const unsigned char byte = *pos++;
+            value |= (uint64_t)( byte & 0x7f ) << shift;
+            if( byte < 0x80 )
+                return true;
+        }
+        return false;
+    }
+
+    inline void append_compact_column( compact_block& block, index col_idx, dimension dim, const column& col ) {
+        append_varint( block, (uint64_t)dim );
+        append_varint( block, (uint64_t)col.size() );
+        for( std::size_t idx = 0; idx < col.size(); idx++ ) {
+            if( idx == 0 )
+                append_varint( block, zigzag_encode( col_idx - col[ 0 ] ) );
+            else
+                append_varint( block, (uint64_t)( col[ idx ] - col[ idx - 1 ] - 1 ) );
+        }
+    }
+
+    inline bool read_compact_column( const unsigned char*& pos, const unsigned char* block_end, index col_idx, dimension& dim, column& col ) {
+        uint64_t cur_dim, nr_rows, value;
+        if( !read_varint( pos, block_end, cur_dim ) || cur_dim > (uint64_t)std::numeric_limits< dimension >::max()
+            || !read_varint( pos, block_end, nr_rows ) || nr_rows > (uint64_t)( block_end - pos ) )
+            return false;
+        dim = (dimension)cur_dim;
+        col.resize( (std::size_t)nr_rows );
+        for( std::size_t idx = 0; idx < col.size(); idx++ ) {
+            if( !read_varint( pos, block_end, value ) )
+                return false;
+            col[ idx ] = idx == 0 ? col_idx - zigzag_decode( value ) : col[ idx - 1 ] + (index)value + 1;
+        }
+        return true;
+    }
+
+    inline void append_compact_pair( compact_block& block, index previous_birth, index birth, index death ) {
+        append_varint( block, zigzag_encode( birth - previous_birth ) );
+        append_varint( block, zigzag_encode( death - birth ) );
+    }
+
+    inline bool read_compact_pair( const unsigned char*& pos, const unsigned char* block_end, index previous_birth, index& birth, index& death ) {
+        uint64_t birth_delta, persistence;
+        if( !read_varint( pos, block_end, birth_delta ) || !read_varint( pos, block_end, persistence ) )
+            return false;
+        birth = previous_birth + zigzag_decode( birth_delta );
+        death = birth + zigzag_decode( persistence );
+        return true;
+    }
+
+    // Writes the header, the block index and the given blocks of 'block_size' items each
+    inline bool save_compact_file( const std::string& filename, compact_content_type content, index nr_items, index block_size,
+                                   const std::vector< compact_block >& blocks ) {
+        std::ofstream output_stream( filename.c_str(), std::ios_base::binary | std::ios_base::out );
+        if( output_stream.fail() )
+            return false;
+
+        compact_block header( "PHATCPCT", "PHATCPCT" + 8 );
+        const uint64_t header_fields[] = { 1 | ( (uint64_t)content << 32 ), (uint64_t)nr_items, (uint64_t)block_size, (uint64_t)blocks.size() };
+        std::vector< uint64_t > words( header_fields, header_fields + 4 );
+        uint64_t block_offset = 0;
+        for( std::size_t block_id = 0; block_id < blocks.size(); block_id++ ) {
+            words.push_back( block_offset );
+            block_offset += blocks[ block_id ].size();
+        }
+        words.push_back( block_offset );
+        for( std::size_t idx = 0; idx < words.size(); idx++ )
+            for( int byte = 0; byte < 8; byte++ )
+                header.push_back( (unsigned char)( words[ idx ] >> ( 8 * byte ) ) );
+
+        output_stream.write( (const char*)header.data(), header.size() );
+        for( std::size_t block_id = 0; block_id < blocks.size(); block_id++ )
+            output_stream.write( (const char*)blocks[ block_id ].data(), blocks[ block_id ].size() );
+
+        output_stream.close();
+        return !output_stream.fail();
+    }
+
+    // A file in compact format, mapped into memory. Opening the file checks the header and the block index;
+    // the blocks themselves are only decoded on demand, and a loader has to check that each of them is
+    // consumed exactly up to get_block_end.
+    class mapped_compact_file {
+
+    protected:
+        mapped_file file;
+        const unsigned char* blocks_begin;
+        std::vector< uint64_t > block_offsets;
+        index nr_items;
+        index block_size;
+
+        enum { header_size = 8 + 4 * 8 };
+
+        uint64_t read_word( std::size_t position ) const {
+            const unsigned char* bytes = (const unsigned char*)file.data() + position;
+            uint64_t word = 0;
+            for( int byte = 7; byte >= 0; byte-- )
+                word = ( word << 8 ) | bytes[ byte ];
+            return word;
+        }
+
+    public:
+        mapped_compact_file() : blocks_begin( 0 ), nr_items( 0 ), block_size( 1 ) {}
+
+        // false if the file cannot be opened, is not in compact format or does not contain 'content'
+        bool open( const std::string& filename, compact_content_type content ) {
+            block_offsets.clear();
+            nr_items = 0;
+            if( !file.open( filename ) )
+                return false;
+
+            if( file.size() < header_size || std::string( file.data(), 8 ) != "PHATCPCT" )
+                return false;
+            const uint64_t version_and_content = read_word( 8 );
+            const uint64_t file_nr_items = read_word( 16 );
+            const uint64_t file_block_size = read_word( 24 );
+            const uint64_t nr_blocks = read_word( 32 );
+            if( ( version_and_content & 0xffffffff ) != 1 || ( version_and_content >> 32 ) != (uint64_t)content
+                || file_nr_items > (uint64_t)std::numeric_limits< index >::max()
+                || file_block_size == 0 || file_block_size > (uint64_t)std::numeric_limits< index >::max()
+                || nr_blocks != file_nr_items / file_block_size + ( file_nr_items % file_block_size != 0 )
+                || nr_blocks >= ( file.size() - header_size ) / 8 )
+                return false;
+
+            const std::size_t index_end = header_size + 8 * ( (std::size_t)nr_blocks + 1 );
+            block_offsets.resize( (std::size_t)nr_blocks + 1 );
+            for( std::size_t block_id = 0; block_id <= nr_blocks; block_id++ ) {
+                block_offsets[ block_id ] = read_word( header_size + 8 * block_id );
+                if( ( block_id > 0 && block_offsets[ block_id ] < block_offsets[ block_id - 1 ] )
+                    || block_offsets[ block_id ] > file.size() - index_end ) {
+                    block_offsets.clear();
+                    return false;
+                }
+            }
+            // every column and every pair takes at least two bytes, so a larger count is corrupt -- and must not be allocated
+            if( file_nr_items > block_offsets.back() / 2 ) {
+                block_offsets.clear();
+                return false;
+            }
+            blocks_begin = (const unsigned char*)file.data() + index_end;
+            nr_items = (index)file_nr_items;
+            block_size = (index)file_block_size;
+            return true;
+        }
+
+        index get_num_items() const { return nr_items; }
+
+        index get_num_blocks() const { return block_offsets.empty() ? 0 : (index)block_offsets.size() - 1; }
+
+        // global index of the first item of the given block; the block after the last one starts at get_num_items()
+        index get_first_item( index block_id ) const { return std::min( block_id * block_size, nr_items ); }
+
+        const unsigned char* get_block_begin( index block_id ) const { return blocks_begin + block_offsets[ block_id ]; }
+
+        const unsigned char* get_block_end( index block_id ) const { return blocks_begin + block_offsets[ block_id + 1 ]; }
+    };
+}
@@ -0,0 +1,104 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "misc.h"
+
+// Compressed columns: the sorted entries of all columns stored back to back in a single buffer, i.e.,
+// column 'idx' consists of entries[ offsets[ idx ] ], ..., entries[ offsets[ idx + 1 ] - 1 ].
+namespace phat {
+
+    // Replaces all columns of 'rep' by the given compressed columns. The input vectors are consumed:
+    // representations that can store the buffer as it is provide an overload of this function that takes it over.
+    template< typename Representation >
+    void load_compressed_columns( Representation& rep, std::vector< dimension >& dims, std::vector< index >& offsets, std::vector< index >& entries ) {
+        const index nr_columns = (index)dims.size();
+        rep._set_num_cols( nr_columns );
+        column temp_col;
+        #pragma omp parallel for private( temp_col )
+        for( index cur_col = 0; cur_col < nr_columns; cur_col++ ) {
+            rep._set_dim( cur_col, dims[ cur_col ] );
+            temp_col.assign( entries.begin() + offsets[ cur_col ], entries.begin() + offsets[ cur_col + 1 ] );
+            rep._set_col( cur_col, temp_col );
+        }
+        std::vector< dimension >().swap( dims );
+        std::vector< index >().swap( offsets );
+        std::vector< index >().swap( entries );
+    }
+
+    // Number of entries of every row of 'matrix', counted by atomic increments while the columns are read in
+    // parallel, so there is a single counter per row whatever the number of threads. The matrix has to be synced.
+    template< typename BoundaryMatrix >
+    void count_row_entries( const BoundaryMatrix& matrix, std::vector< index >& row_entries ) {
+        const index nr_columns = matrix.get_num_cols();
+        row_entries.assign( nr_columns, 0 );
+        column temp_col;
+        #pragma omp parallel for schedule( dynamic, 1024 ) private( temp_col )
+        for( index cur_col = 0; cur_col < nr_columns; cur_col++ ) {
+            matrix.get_col( cur_col, temp_col );
+            for( index idx = 0; idx < (index)temp_col.size(); idx++ ) {
+                #pragma omp atomic
+                row_entries[ temp_col[ idx ] ]++;
+            }
+        }
+    }
+
+    // Transpose of 'matrix' as compressed columns, i.e., row 'row' contains the columns entries[ offsets[ row ] ], ...,
+    // entries[ offsets[ row + 1 ] - 1 ] in increasing order. The prefix sum of count_row_entries gives each row its
+    // slots, which the columns claim by atomically advancing the start of the row in 'offsets' -- so no row is
+    // allocated on its own and the only scratch memory is the output. Afterwards each row is sorted.
+    template< typename BoundaryMatrix >
+    void compute_compressed_transpose( const BoundaryMatrix& matrix, std::vector< index >& offsets, std::vector< index >& entries ) {
+        const index nr_columns = matrix.get_num_cols();
+        offsets.reserve( nr_columns + 1 );
+        count_row_entries( matrix, offsets );
+        offsets.insert( offsets.begin(), 0 );
+        for( index row = 0; row < nr_columns; row++ )
+            offsets[ row + 1 ] += offsets[ row ];
+
+        // A locked instruction waits for all pending stores, so the slots of a whole block of columns are claimed
+        // before any entry is stored.
+        entries.resize( offsets[ nr_columns ] );
+        const index block_size = 1024;
+        const index nr_blocks = ( nr_columns + block_size - 1 ) / block_size;
+        column temp_col, block_slots, block_cols;
+        #pragma omp parallel for schedule( dynamic, 1 ) private( temp_col, block_slots, block_cols )
+        for( index block_id = 0; block_id < nr_blocks; block_id++ ) {
+            block_slots.clear();
+            block_cols.clear();
+            const index block_end = std::min( ( block_id + 1 ) * block_size, nr_columns );
+            for( index cur_col = block_id * block_size; cur_col < block_end; cur_col++ ) {
+                matrix.get_col( cur_col, temp_col );
+                for( index idx = 0; idx < (index)temp_col.size(); idx++ ) {
+                    index position;
+                    #pragma omp atomic capture
+                    position = offsets[ temp_col[ idx ] ]++;
+                    block_slots.push_back( position );
+                    block_cols.push_back( cur_col );
+                }
+            }
+            for( index idx = 0; idx < (index)block_slots.size(); idx++ )
+                entries[ block_slots[ idx ] ] = block_cols[ idx ];
+        }
+
+        // every row start has been advanced to the start of the next row
+        std::copy_backward( offsets.begin(), offsets.end() - 1, offsets.end() );
+        offsets[ 0 ] = 0;
+        #pragma omp parallel for schedule( dynamic, 1024 )
+        for( index row = 0; row < nr_columns; row++ )
+            std::sort( entries.begin() + offsets[ row ], entries.begin() + offsets[ row + 1 ] );
+    }
+}
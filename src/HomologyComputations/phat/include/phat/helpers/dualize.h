@@ -24,45 +24,41 @@
 
 
 namespace phat {
+    // Replaces the boundary matrix by its anti-transpose: the compressed transpose (see helpers/compressed_columns.h)
+    // read backwards, with every index i replaced by nr_of_columns - 1 - i. The buffer is handed to the
+    // representation as it is.
     template< typename Representation >
     void dualize( boundary_matrix< Representation >& boundary_matrix ) {
 
-        std::vector< dimension > dual_dims;
-        std::vector< std::vector< index > > dual_matrix;
+        const index nr_of_columns = boundary_matrix.get_num_cols();
 
-        index nr_of_columns = boundary_matrix.get_num_cols();
-        dual_matrix.resize( nr_of_columns );
-        dual_dims.resize( nr_of_columns );
-        
-        std::vector< index > dual_sizes( nr_of_columns, 0 );
+        // pivot columns of the representation must not be thread-local while the columns are read in parallel
+        boundary_matrix.sync();
 
-        column temp_col;
-        for( index cur_col = 0; cur_col < nr_of_columns; cur_col++ ) {
-            boundary_matrix.get_col( cur_col, temp_col );
-            for( index idx = 0; idx < (index)temp_col.size(); idx++)
-                    dual_sizes[ nr_of_columns - 1 - temp_col[ idx ]  ]++;
-        }
- 
-        #pragma omp parallel for 
-        for( index cur_col = 0; cur_col < nr_of_columns; cur_col++ )
-            dual_matrix[cur_col].reserve(dual_sizes[cur_col]);
+        std::vector< index > dual_offsets, dual_entries;
+        compute_compressed_transpose( boundary_matrix, dual_offsets, dual_entries );
 
-        for( index cur_col = 0; cur_col < nr_of_columns; cur_col++ ) {
-            boundary_matrix.get_col( cur_col, temp_col );
-            for( index idx = 0; idx < (index)temp_col.size(); idx++)
-                dual_matrix[ nr_of_columns - 1 - temp_col[ idx ]  ].push_back( nr_of_columns - 1 - cur_col );
+        const index nr_of_entries = (index)dual_entries.size();
+        std::reverse( dual_offsets.begin(), dual_offsets.end() );
+        #pragma omp parallel for
+        for( index dual_col = 0; dual_col <= nr_of_columns; dual_col++ )
+            dual_offsets[ dual_col ] = nr_of_entries - dual_offsets[ dual_col ];
+        #pragma omp parallel for
+        for( index idx = 0; idx < nr_of_entries / 2; idx++ ) {
+            const index front = dual_entries[ idx ];
+            dual_entries[ idx ] = nr_of_columns - 1 - dual_entries[ nr_of_entries - 1 - idx ];
+            dual_entries[ nr_of_entries - 1 - idx ] = nr_of_columns - 1 - front;
         }
+        if( nr_of_entries % 2 == 1 )
+            dual_entries[ nr_of_entries / 2 ] = nr_of_columns - 1 - dual_entries[ nr_of_entries / 2 ];
 
         const dimension max_dim = boundary_matrix.get_max_dim();
+        std::vector< dimension > dual_dims( nr_of_columns );
         #pragma omp parallel for
         for( index cur_col = 0; cur_col < nr_of_columns; cur_col++ )
             dual_dims[ nr_of_columns - 1 - cur_col ] = max_dim - boundary_matrix.get_dim( cur_col );
 
-        #pragma omp parallel for
-        for( index cur_col = 0; cur_col < nr_of_columns; cur_col++ )
-            std::reverse( dual_matrix[ cur_col ].begin(), dual_matrix[ cur_col ].end() );
-
-        boundary_matrix.load_vector_vector( dual_matrix, dual_dims );
+        boundary_matrix.load_compressed( dual_dims, dual_offsets, dual_entries );
     }
     
     void dualize_persistence_pairs( persistence_pairs& pairs, const index n ) {
@@ -0,0 +1,327 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "misc.h"
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+    #define PHAT_HAVE_MMAP
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace phat {
+
+    // Read-only view of a whole file. The file is memory mapped where mmap is available and read into
+    // memory otherwise.
+    class mapped_file {
+
+    protected:
+        const char* mapped_data;
+        std::size_t mapped_size;
+        std::vector< char > buffer;
+
+    private:
+        // the mapping is released in the destructor, so copies are not allowed
+        mapped_file( const mapped_file& );
+        mapped_file& operator=( const mapped_file& );
+
+    public:
+        mapped_file() : mapped_data( 0 ), mapped_size( 0 ) {}
+
+        ~mapped_file() {
+            close();
+        }
+
+        bool open( const std::string& filename ) {
+            close();
+#ifdef PHAT_HAVE_MMAP
+            const int file_descriptor = ::open( filename.c_str(), O_RDONLY );
+            if( file_descriptor < 0 )
+                return false;
+            struct stat file_status;
+            if( fstat( file_descriptor, &file_status ) != 0 ) {
+                ::close( file_descriptor );
+                return false;
+            }
+            mapped_size = (std::size_t)file_status.st_size;
+            if( mapped_size > 0 ) {
+                void* address = mmap( 0, mapped_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0 );
+                if( address == MAP_FAILED ) {
+                    ::close( file_descriptor );
+                    mapped_size = 0;
+                    return false;
+                }
+                mapped_data = (const char*)address;
+            }
+            // the mapping stays valid after the descriptor is closed
+            ::close( file_descriptor );
+            return true;
+#else
+            std::ifstream input_stream( filename.c_str(), std::ios_base::binary | std::ios_base::in );
+            if( input_stream.fail() )
+                return false;
+            input_stream.seekg( 0, std::ios_base::end );
+            buffer.resize( (std::size_t)input_stream.tellg() );
+            input_stream.seekg( 0, std::ios_base::beg );
+            if( !buffer.empty() && !input_stream.read( &buffer[ 0 ], buffer.size() ) )
+                return false;
+            mapped_data = buffer.empty() ? 0 : &buffer[ 0 ];
+            mapped_size = buffer.size();
+            return true;
+#endif
+        }
+
+        void close() {
+#ifdef PHAT_HAVE_MMAP
+            if( mapped_data )
+                munmap( (void*)mapped_data, mapped_size );
+#endif
+            std::vector< char >().swap( buffer );
+            mapped_data = 0;
+            mapped_size = 0;
+        }
+
+        const char* data() const { return mapped_data; }
+
+        std::size_t size() const { return mapped_size; }
+    };
+
+    // A boundary matrix file in binary format, mapped into memory. Opening the file makes one pass over
+    // the column headers to find where each column starts; the row indices are only read on demand.
+    // Format: nr_columns % dim1 % N1 % row1 row2 % ...% rowN1 % dim2 % N2 % ...
+    class mapped_binary_matrix {
+
+    protected:
+        mapped_file file;
+        const int64_t* words;
+        std::vector< int64_t > col_offsets; // position of the dimension of each column in 'words'
+
+    public:
+        mapped_binary_matrix() : words( 0 ) {}
+
+        // false if the file cannot be opened or is truncated
+        bool open( const std::string& filename ) {
+            col_offsets.clear();
+            if( !file.open( filename ) )
+                return false;
+
+            words = (const int64_t*)file.data();
+            const int64_t nr_words = (int64_t)( file.size() / sizeof( int64_t ) );
+            // every column takes at least two words, so a larger count is corrupt -- and must not be allocated
+            if( nr_words < 1 || words[ 0 ] < 0 || words[ 0 ] > ( nr_words - 1 ) / 2 )
+                return false;
+
+            const int64_t nr_columns = words[ 0 ];
+            col_offsets.resize( (std::size_t)nr_columns );
+            int64_t position = 1;
+            for( int64_t cur_col = 0; cur_col < nr_columns; cur_col++ ) {
+                if( position + 2 > nr_words || words[ position + 1 ] < 0 || words[ position + 1 ] > nr_words - position - 2 ) {
+                    col_offsets.clear();
+                    return false;
+                }
+                col_offsets[ cur_col ] = position;
+                position += 2 + words[ position + 1 ];
+            }
+            return true;
+        }
+
+        index get_num_cols() const { return (index)col_offsets.size(); }
+
+        dimension get_dim( index idx ) const { return (dimension)words[ col_offsets[ idx ] ]; }
+
+        index get_num_rows( index idx ) const { return (index)words[ col_offsets[ idx ] + 1 ]; }
+
+        // sorted row indices of the given column, as stored in the file
+        const int64_t* get_rows( index idx ) const { return words + col_offsets[ idx ] + 2; }
+    };
+
+    // A boundary matrix file in ascii format, mapped into memory. Opening the file splits it into line-aligned
+    // chunks and counts the columns of each chunk in parallel, so that afterwards every chunk can be parsed
+    // straight into its final columns by one thread.
+    // Format: each line represents a column, first number is dimension, other numbers are the content of the column.
+    // Ignores empty lines and lines starting with a '#'.
+    class mapped_ascii_matrix {
+
+    protected:
+        mapped_file file;
+        std::vector< const char* > chunk_boundaries; // every chunk starts at the beginning of a line
+        std::vector< index > chunk_first_cols;       // global index of the first column of each chunk, plus the total
+
+        // chunks are made smaller than this only if there are too few to keep all threads busy
+        enum { min_chunk_size = 1 << 20 };
+        enum { chunks_per_thread = 4 };
+
+        static bool is_blank( char c ) {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+        }
+
+        static bool is_digit( char c ) {
+            return (unsigned)( c - '0' ) < 10;
+        }
+
+        static const char* skip_blanks( const char* pos, const char* chunk_end ) {
+            while( pos != chunk_end && is_blank( *pos ) )
+                pos++;
+            return pos;
+        }
+
+        static const char* next_line( const char* pos, const char* chunk_end ) {
+            const char* line_end = (const char*)memchr( pos, '\n', chunk_end - pos );
+            return line_end == 0 ? chunk_end : line_end + 1;
+        }
+
+        // parses the non-negative integer at 'pos'; false if there is no number or it is not followed by a blank or a line break
+        static bool parse_index( const char*& pos, const char* chunk_end, index& value ) {
+            const char* number_begin = pos;
+            uint64_t result = 0;
+            while( pos != chunk_end && is_digit( *pos ) )
+                result = result * 10 + (unsigned)( *pos++ - '0' );
+            if( pos == number_begin || pos - number_begin > 18 || ( pos != chunk_end && *pos != '\n' && !is_blank( *pos ) ) )
+                return false;
+            value = (index)result;
+            return true;
+        }
+
+        static index count_chunk_columns( const char* pos, const char* chunk_end ) {
+            index nr_columns = 0;
+            for( ; pos != chunk_end; pos = next_line( pos, chunk_end ) )
+                if( is_column( pos, chunk_end ) )
+                    nr_columns++;
+            return nr_columns;
+        }
+
+    public:
+        // false if the file cannot be opened
+        bool open( const std::string& filename ) {
+            chunk_boundaries.clear();
+            chunk_first_cols.assign( 1, 0 );
+            if( !file.open( filename ) )
+                return false;
+
+            const char* const file_begin = file.data();
+            const char* const file_end = file_begin + file.size();
+            const std::size_t nr_chunks_wanted = std::max( (std::size_t)1,
+                std::min( (std::size_t)chunks_per_thread * omp_get_max_threads(), file.size() / min_chunk_size ) );
+
+            chunk_boundaries.push_back( file_begin );
+            for( std::size_t chunk_id = 1; chunk_id < nr_chunks_wanted; chunk_id++ ) {
+                const char* chunk_begin = next_line( file_begin + file.size() / nr_chunks_wanted * chunk_id - 1, file_end );
+                if( chunk_begin == file_end )
+                    break;
+                if( chunk_begin > chunk_boundaries.back() )
+                    chunk_boundaries.push_back( chunk_begin );
+            }
+            chunk_boundaries.push_back( file_end );
+
+            const index nr_chunks = (index)chunk_boundaries.size() - 1;
+            chunk_first_cols.resize( nr_chunks + 1 );
+            #pragma omp parallel for schedule( dynamic, 1 )
+            for( index chunk_id = 0; chunk_id < nr_chunks; chunk_id++ )
+                chunk_first_cols[ chunk_id + 1 ] = count_chunk_columns( chunk_boundaries[ chunk_id ], chunk_boundaries[ chunk_id + 1 ] );
+            for( index chunk_id = 0; chunk_id < nr_chunks; chunk_id++ )
+                chunk_first_cols[ chunk_id + 1 ] += chunk_first_cols[ chunk_id ];
+            return true;
+        }
+
+        // true iff the line starting at 'pos' describes a column, i.e., is neither empty nor a comment
+        static bool is_column( const char* pos, const char* line_end ) {
+            pos = skip_blanks( pos, line_end );
+            return pos != line_end && *pos != '\n' && *pos != '#';
+        }
+
+        // parses the column on the line starting at 'pos' and moves 'pos' to the end of the line -- false if the
+        // line contains something other than blanks and non-negative integers. Columns that are not sorted get sorted.
+        static bool parse_column( const char*& pos, const char* line_end, dimension& dim, column& col ) {
+            index cur_dim;
+            pos = skip_blanks( pos, line_end );
+            if( !parse_index( pos, line_end, cur_dim ) || cur_dim > std::numeric_limits< dimension >::max() )
+                return false;
+            dim = (dimension)cur_dim;
+
+            col.clear();
+            bool is_sorted = true;
+            for( pos = skip_blanks( pos, line_end ); pos != line_end && *pos != '\n'; pos = skip_blanks( pos, line_end ) ) {
+                index cur_row;
+                if( !parse_index( pos, line_end, cur_row ) )
+                    return false;
+                is_sorted = is_sorted && ( col.empty() || col.back() < cur_row );
+                col.push_back( cur_row );
+            }
+            if( !is_sorted )
+                std::sort( col.begin(), col.end() );
+            return true;
+        }
+
+        index get_num_cols() const { return chunk_first_cols.back(); }
+
+        index get_num_chunks() const { return (index)chunk_boundaries.size() - 1; }
+
+        // global index of the first column of the given chunk; the chunk after the last one starts at get_num_cols()
+        index get_first_col( index chunk_id ) const { return chunk_first_cols[ chunk_id ]; }
+
+        // parses all columns of the given chunk into 'rep' -- false if the chunk contains something other than
+        // blanks and non-negative integers
+        template< typename Representation >
+        bool parse_chunk( index chunk_id, Representation& rep, column& temp_col ) const {
+            const char* pos = chunk_boundaries[ chunk_id ];
+            const char* const chunk_end = chunk_boundaries[ chunk_id + 1 ];
+            for( index cur_col = chunk_first_cols[ chunk_id ]; pos != chunk_end; pos = next_line( pos, chunk_end ) ) {
+                if( !is_column( pos, chunk_end ) )
+                    continue;
+
+                dimension cur_dim;
+                if( !parse_column( pos, chunk_end, cur_dim, temp_col ) )
+                    return false;
+
+                rep._set_dim( cur_col, cur_dim );
+                rep._set_col( cur_col, temp_col );
+                cur_col++;
+            }
+            return true;
+        }
+    };
+
+    // Parses all columns of 'input' into 'rep', one chunk per thread at a time
+    template< typename Representation >
+    bool load_mapped_ascii( Representation& rep, const mapped_ascii_matrix& input ) {
+        rep._set_num_cols( input.get_num_cols() );
+        bool is_valid = true;
+        column temp_col;
+        #pragma omp parallel for schedule( dynamic, 1 ) private( temp_col ) reduction( && : is_valid )
+        for( index chunk_id = 0; chunk_id < input.get_num_chunks(); chunk_id++ )
+            is_valid = input.parse_chunk( chunk_id, rep, temp_col ) && is_valid;
+        return is_valid;
+    }
+
+    // Copies all columns of 'input' into 'rep'. Representations that can work on the mapped file
+    // directly provide an overload of this function.
+    template< typename Representation >
+    void load_mapped_binary( Representation& rep, const std::shared_ptr< const mapped_binary_matrix >& input ) {
+        const index nr_columns = input->get_num_cols();
+        rep._set_num_cols( nr_columns );
+        column temp_col;
+        #pragma omp parallel for private( temp_col )
+        for( index cur_col = 0; cur_col < nr_columns; cur_col++ ) {
+            rep._set_dim( cur_col, input->get_dim( cur_col ) );
+            const int64_t* rows = input->get_rows( cur_col );
+            temp_col.assign( rows, rows + input->get_num_rows( cur_col ) );
+            rep._set_col( cur_col, temp_col );
+        }
+    }
+}
@@ -25,6 +25,7 @@
 #include <vector>
 #include <set>
 #include <list>
+#include <deque>
 #include <map>
 #include <algorithm>
 #include <queue>
@@ -34,7 +35,11 @@
 #include <iomanip>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <iterator>
+#include <limits>
+#include <atomic>
+#include <memory>
 
 // VS2008 and below unfortunately do not support stdint.h
 #if defined(_MSC_VER)&& _MSC_VER < 1600
@@ -50,7 +55,8 @@
     #include <stdint.h>
 #endif
 
-// basic types. index can be changed to int32_t to save memory on small instances
+// basic types. index is used throughout the interfaces; to save memory on small instances,
+// representations can store their entries in a narrower type instead (e.g. vector_vector_32)
 namespace phat {
     typedef int64_t index;
     typedef int8_t dimension;
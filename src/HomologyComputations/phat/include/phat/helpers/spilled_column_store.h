@@ -0,0 +1,137 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "misc.h"
+
+namespace phat {
+
+    // Stores finalized columns by index. As soon as more than 'memory_budget' row indices are held in memory,
+    // the oldest columns are appended to a spill file and read back whenever they are needed again.
+    // Columns are never modified after they were stored. If writing the spill file fails (e.g., the disk is full), the
+    // columns stay in memory, no more columns are spilled and set_col reports the failure.
+    class spilled_column_store {
+
+    protected:
+        std::vector< column > resident_columns;
+        std::vector< int64_t > spill_offsets;   // position of each spilled column in the spill file, -1 otherwise
+        std::deque< index > resident_order;     // indices of the resident columns, oldest first
+        index nr_resident_entries;
+        index memory_budget;
+
+        std::string spill_filename;
+        std::fstream spill_file;
+        int64_t spill_file_size;
+        bool has_spill_failed;
+
+    private:
+        // the spill file is deleted in the destructor, so copies are not allowed
+        spilled_column_store( const spilled_column_store& );
+        spilled_column_store& operator=( const spilled_column_store& );
+
+    protected:
+        // false if the column could not be written, it is resident then
+        bool _spill_oldest_column() {
+            const index idx = resident_order.front();
+            column& col = resident_columns[ idx ];
+            const int64_t nr_rows = (int64_t)col.size();
+            spill_file.seekp( spill_file_size );
+            spill_file.write( (const char*)&nr_rows, sizeof( int64_t ) );
+            spill_file.write( (const char*)col.data(), nr_rows * sizeof( int64_t ) );
+            spill_file.flush();
+            if( spill_file.fail() ) {
+                spill_file.clear();
+                return false;
+            }
+            resident_order.pop_front();
+            spill_offsets[ idx ] = spill_file_size;
+            spill_file_size += ( nr_rows + 1 ) * sizeof( int64_t );
+            nr_resident_entries -= nr_rows;
+            column().swap( col );
+            return true;
+        }
+
+    public:
+        // a negative 'memory_budget' or an empty 'spill_filename' keeps all columns in memory
+        spilled_column_store( index memory_budget = -1, const std::string& spill_filename = "" )
+            : nr_resident_entries( 0 ), memory_budget( memory_budget ), spill_filename( spill_filename ), spill_file_size( 0 ), has_spill_failed( false ) {
+            if( memory_budget >= 0 && !spill_filename.empty() ) {
+                spill_file.open( spill_filename.c_str(), std::ios_base::binary | std::ios_base::in | std::ios_base::out | std::ios_base::trunc );
+                if( spill_file.fail() )
+                    this->memory_budget = -1;
+            } else {
+                this->memory_budget = -1;
+            }
+        }
+
+        ~spilled_column_store() {
+            if( spill_file.is_open() ) {
+                spill_file.close();
+                std::remove( spill_filename.c_str() );
+            }
+        }
+
+        index get_num_cols() const { return (index)resident_columns.size(); }
+
+        index get_num_resident_entries() const { return nr_resident_entries; }
+
+        index get_num_spilled_bytes() const { return spill_file_size; }
+
+        // true if writing the spill file failed at some point
+        bool spill_failed() const { return has_spill_failed; }
+
+        // Stores 'col' as column 'idx' and leaves 'col' with unspecified content. Returns false if older columns
+        // had to be spilled but the spill file could not be written -- the column is stored nonetheless.
+        bool set_col( index idx, column& col ) {
+            if( idx >= (index)resident_columns.size() ) {
+                resident_columns.resize( idx + 1 );
+                spill_offsets.resize( idx + 1, -1 );
+            }
+            resident_columns[ idx ].swap( col );
+            resident_order.push_back( idx );
+            nr_resident_entries += (index)resident_columns[ idx ].size();
+            while( memory_budget >= 0 && nr_resident_entries > memory_budget && resident_order.size() > 1 ) {
+                if( !_spill_oldest_column() ) {
+                    has_spill_failed = true;
+                    memory_budget = -1;
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Returns column 'idx', reading it into 'buffer' if it was spilled -- or 0 if it cannot be read back.
+        const column* get_col( index idx, column& buffer ) {
+            if( spill_offsets[ idx ] < 0 )
+                return &resident_columns[ idx ];
+
+            int64_t nr_rows = -1;
+            spill_file.seekg( spill_offsets[ idx ] );
+            spill_file.read( (char*)&nr_rows, sizeof( int64_t ) );
+            if( spill_file.fail() || nr_rows < 0 || nr_rows > ( spill_file_size - spill_offsets[ idx ] ) / (int64_t)sizeof( int64_t ) - 1 ) {
+                spill_file.clear();
+                return 0;
+            }
+            buffer.resize( (std::size_t)nr_rows );
+            spill_file.read( (char*)buffer.data(), nr_rows * sizeof( int64_t ) );
+            if( spill_file.fail() ) {
+                spill_file.clear();
+                return 0;
+            }
+            return &buffer;
+        }
+    };
+}
@@ -0,0 +1,425 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "misc.h"
+
+// The vectorized kernels need per-function target attributes and cpu feature detection at runtime.
+// Define PHAT_NO_SIMD to always use the portable kernel.
+#if !defined( PHAT_NO_SIMD ) && defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )               \
+    && ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) || defined( __clang__ ) )
+    #define PHAT_X86_SIMD
+    #include <immintrin.h>
+#endif
+
+// Symmetric difference of two sorted index ranges, i.e., the sum of two columns over Z2.
+// The output needs room for na + nb entries and may be written up to that bound, even
+// if the result is shorter.
+namespace phat {
+
+    // branch-free merge: one output slot is written per step and only kept if the two heads differ
+    template< typename T >
+    T* symmetric_difference_scalar( const T* a, const T* a_end, const T* b, const T* b_end, T* out ) {
+        if( a != a_end && b != b_end ) {
+            while( true ) {
+                const T x = *a;
+                const T y = *b;
+                *out = x < y ? x : y;
+                out += ( x != y );
+                a += ( x <= y );
+                b += ( y <= x );
+                if( a == a_end || b == b_end )
+                    break;
+            }
+        }
+        out = std::copy( a, a_end, out );
+        return std::copy( b, b_end, out );
+    }
+
+    // Finishes a vectorized merge: 'rest' holds the sorted entries that were loaded but not yet written
+    // (duplicates among them are adjacent). They are merged with the heads of both ranges until they are
+    // used up, the remainder of the two ranges is left to the caller.
+    template< typename T >
+    T* symmetric_difference_drain( T* rest, T* rest_end, const T*& a, const T* a_end, const T*& b, const T* b_end, T* out ) {
+        T* unique_end = rest;
+        for( T* it = rest; it != rest_end; it++ ) {
+            if( it + 1 != rest_end && *it == *( it + 1 ) )
+                it++;
+            else
+                *unique_end++ = *it;
+        }
+        for( const T* r = rest; r != unique_end; ) {
+            T smallest = *r;
+            if( a != a_end && *a < smallest ) smallest = *a;
+            if( b != b_end && *b < smallest ) smallest = *b;
+            int count = 0;
+            if( *r == smallest ) { r++; count++; }
+            if( a != a_end && *a == smallest ) { a++; count++; }
+            if( b != b_end && *b == smallest ) { b++; count++; }
+            if( count == 1 ) *out++ = smallest;
+        }
+        return out;
+    }
+
+#ifdef PHAT_X86_SIMD
+    // The vectorized kernels are a merge network: the next block is always loaded from the range with the
+    // smaller head, merged with the upper half of the previous merge by a bitonic network, and the lower
+    // half is written out after dropping every entry that equals one of its neighbours. The last entry
+    // of a written block is taken back if it equals the first entry of the next one.
+    // The Ops classes provide the width-specific instructions.
+    #define PHAT_TARGET_AVX2 __attribute__(( target( "avx2,popcnt" ) ))
+    #define PHAT_TARGET_AVX512 __attribute__(( target( "avx512f,popcnt" ) ))
+
+    // permutations for packing the selected lanes of a 256-bit vector to the front
+    template< int width >
+    class avx2_compress_table {
+        int32_t permutations[ 1 << width ][ 8 ];
+
+    public:
+        avx2_compress_table() {
+            const int dwords_per_lane = 8 / width;
+            for( int mask = 0; mask < ( 1 << width ); mask++ ) {
+                int pos = 0;
+                for( int lane = 0; lane < width; lane++ )
+                    if( mask & ( 1 << lane ) )
+                        for( int dword = 0; dword < dwords_per_lane; dword++ )
+                            permutations[ mask ][ pos++ ] = lane * dwords_per_lane + dword;
+                while( pos < 8 )
+                    permutations[ mask ][ pos++ ] = 0;
+            }
+        }
+
+        const int32_t* operator[]( int mask ) const { return permutations[ mask ]; }
+
+        static const avx2_compress_table& get() {
+            static const avx2_compress_table table;
+            return table;
+        }
+    };
+
+    class avx2_ops_64 {
+        const avx2_compress_table< 4 >& table;
+
+        PHAT_TARGET_AVX2 static void min_max( __m256i& lo, __m256i& hi ) {
+            const __m256i greater = _mm256_cmpgt_epi64( lo, hi );
+            const __m256i new_lo = _mm256_blendv_epi8( lo, hi, greater );
+            hi = _mm256_blendv_epi8( hi, lo, greater );
+            lo = new_lo;
+        }
+
+        PHAT_TARGET_AVX2 static __m256i sort_bitonic( __m256i v ) {
+            __m256i other = _mm256_permute4x64_epi64( v, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+            __m256i lo = v;
+            min_max( lo, other );
+            v = _mm256_blend_epi32( lo, other, 0xF0 );
+            other = _mm256_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+            lo = v;
+            min_max( lo, other );
+            return _mm256_blend_epi32( lo, other, 0xCC );
+        }
+
+    public:
+        typedef int64_t value_type;
+        typedef __m256i vector;
+        enum { width = 4 };
+
+        avx2_ops_64() : table( avx2_compress_table< 4 >::get() ) {}
+
+        PHAT_TARGET_AVX2 static vector load( const value_type* ptr ) { return _mm256_loadu_si256( (const __m256i*)ptr ); }
+
+        PHAT_TARGET_AVX2 static void store( value_type* ptr, vector v ) { _mm256_storeu_si256( (__m256i*)ptr, v ); }
+
+        PHAT_TARGET_AVX2 static value_type first( vector v ) { return _mm_cvtsi128_si64( _mm256_castsi256_si128( v ) ); }
+
+        PHAT_TARGET_AVX2 static value_type last( vector v ) { return _mm256_extract_epi64( v, 3 ); }
+
+        // merges the sorted vectors: afterwards 'lo' holds the smaller and 'hi' the larger half, both sorted
+        PHAT_TARGET_AVX2 static void merge( vector& lo, vector& hi ) {
+            hi = _mm256_permute4x64_epi64( hi, _MM_SHUFFLE( 0, 1, 2, 3 ) );
+            min_max( lo, hi );
+            lo = sort_bitonic( lo );
+            hi = sort_bitonic( hi );
+        }
+
+        // lanes i < width - 1 with v[ i ] == v[ i + 1 ]
+        PHAT_TARGET_AVX2 static unsigned equal_to_next( vector v ) {
+            const __m256i next = _mm256_permute4x64_epi64( v, _MM_SHUFFLE( 0, 3, 2, 1 ) );
+            return _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpeq_epi64( v, next ) ) ) & 0x7;
+        }
+
+        // writes the lanes in 'keep' to consecutive slots -- all lanes are written, so 'out' needs room for a full vector
+        PHAT_TARGET_AVX2 value_type* compress_store( value_type* out, unsigned keep, vector v ) const {
+            const __m256i permutation = _mm256_loadu_si256( (const __m256i*)table[ keep ] );
+            _mm256_storeu_si256( (__m256i*)out, _mm256_permutevar8x32_epi32( v, permutation ) );
+            return out + _mm_popcnt_u32( keep );
+        }
+    };
+
+    class avx2_ops_32 {
+        const avx2_compress_table< 8 >& table;
+
+        PHAT_TARGET_AVX2 static __m256i sort_bitonic( __m256i v ) {
+            __m256i other = _mm256_permute2x128_si256( v, v, 1 );
+            v = _mm256_blend_epi32( _mm256_min_epi32( v, other ), _mm256_max_epi32( v, other ), 0xF0 );
+            other = _mm256_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+            v = _mm256_blend_epi32( _mm256_min_epi32( v, other ), _mm256_max_epi32( v, other ), 0xCC );
+            other = _mm256_shuffle_epi32( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+            return _mm256_blend_epi32( _mm256_min_epi32( v, other ), _mm256_max_epi32( v, other ), 0xAA );
+        }
+
+    public:
+        typedef int32_t value_type;
+        typedef __m256i vector;
+        enum { width = 8 };
+
+        avx2_ops_32() : table( avx2_compress_table< 8 >::get() ) {}
+
+        PHAT_TARGET_AVX2 static vector load( const value_type* ptr ) { return _mm256_loadu_si256( (const __m256i*)ptr ); }
+
+        PHAT_TARGET_AVX2 static void store( value_type* ptr, vector v ) { _mm256_storeu_si256( (__m256i*)ptr, v ); }
+
+        PHAT_TARGET_AVX2 static value_type first( vector v ) { return _mm_cvtsi128_si32( _mm256_castsi256_si128( v ) ); }
+
+        PHAT_TARGET_AVX2 static value_type last( vector v ) { return _mm256_extract_epi32( v, 7 ); }
+
+        PHAT_TARGET_AVX2 static void merge( vector& lo, vector& hi ) {
+            hi = _mm256_permutevar8x32_epi32( hi, _mm256_set_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ) );
+            const __m256i new_lo = _mm256_min_epi32( lo, hi );
+            hi = sort_bitonic( _mm256_max_epi32( lo, hi ) );
+            lo = sort_bitonic( new_lo );
+        }
+
+        PHAT_TARGET_AVX2 static unsigned equal_to_next( vector v ) {
+            const __m256i next = _mm256_permutevar8x32_epi32( v, _mm256_set_epi32( 0, 7, 6, 5, 4, 3, 2, 1 ) );
+            return _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( v, next ) ) ) & 0x7F;
+        }
+
+        PHAT_TARGET_AVX2 value_type* compress_store( value_type* out, unsigned keep, vector v ) const {
+            const __m256i permutation = _mm256_loadu_si256( (const __m256i*)table[ keep ] );
+            _mm256_storeu_si256( (__m256i*)out, _mm256_permutevar8x32_epi32( v, permutation ) );
+            return out + _mm_popcnt_u32( keep );
+        }
+    };
+
+    class avx512_ops_64 {
+        PHAT_TARGET_AVX512 static __m512i half_clean( __m512i v, __m512i other, __mmask8 upper ) {
+            return _mm512_mask_blend_epi64( upper, _mm512_min_epi64( v, other ), _mm512_max_epi64( v, other ) );
+        }
+
+        PHAT_TARGET_AVX512 static __m512i sort_bitonic( __m512i v ) {
+            v = half_clean( v, _mm512_shuffle_i64x2( v, v, _MM_SHUFFLE( 1, 0, 3, 2 ) ), 0xF0 );
+            v = half_clean( v, _mm512_shuffle_i64x2( v, v, _MM_SHUFFLE( 2, 3, 0, 1 ) ), 0xCC );
+            return half_clean( v, _mm512_shuffle_epi32( v, (_MM_PERM_ENUM)_MM_SHUFFLE( 1, 0, 3, 2 ) ), 0xAA );
+        }
+
+    public:
+        typedef int64_t value_type;
+        typedef __m512i vector;
+        enum { width = 8 };
+
+        PHAT_TARGET_AVX512 static vector load( const value_type* ptr ) { return _mm512_loadu_si512( (const void*)ptr ); }
+
+        PHAT_TARGET_AVX512 static void store( value_type* ptr, vector v ) { _mm512_storeu_si512( (void*)ptr, v ); }
+
+        PHAT_TARGET_AVX512 static value_type first( vector v ) { return _mm_cvtsi128_si64( _mm512_castsi512_si128( v ) ); }
+
+        PHAT_TARGET_AVX512 static value_type last( vector v ) { return _mm_extract_epi64( _mm512_extracti32x4_epi32( v, 3 ), 1 ); }
+
+        PHAT_TARGET_AVX512 static void merge( vector& lo, vector& hi ) {
+            hi = _mm512_permutexvar_epi64( _mm512_set_epi64( 0, 1, 2, 3, 4, 5, 6, 7 ), hi );
+            const __m512i new_lo = _mm512_min_epi64( lo, hi );
+            hi = sort_bitonic( _mm512_max_epi64( lo, hi ) );
+            lo = sort_bitonic( new_lo );
+        }
+
+        PHAT_TARGET_AVX512 static unsigned equal_to_next( vector v ) {
+            return _mm512_cmpeq_epi64_mask( v, _mm512_alignr_epi64( v, v, 1 ) ) & 0x7F;
+        }
+
+        // only the lanes in 'keep' are written
+        PHAT_TARGET_AVX512 value_type* compress_store( value_type* out, unsigned keep, vector v ) const {
+            _mm512_mask_compressstoreu_epi64( out, (__mmask8)keep, v );
+            return out + _mm_popcnt_u32( keep );
+        }
+    };
+
+    class avx512_ops_32 {
+        PHAT_TARGET_AVX512 static __m512i half_clean( __m512i v, __m512i other, __mmask16 upper ) {
+            return _mm512_mask_blend_epi32( upper, _mm512_min_epi32( v, other ), _mm512_max_epi32( v, other ) );
+        }
+
+        PHAT_TARGET_AVX512 static __m512i sort_bitonic( __m512i v ) {
+            v = half_clean( v, _mm512_shuffle_i64x2( v, v, _MM_SHUFFLE( 1, 0, 3, 2 ) ), 0xFF00 );
+            v = half_clean( v, _mm512_shuffle_i64x2( v, v, _MM_SHUFFLE( 2, 3, 0, 1 ) ), 0xF0F0 );
+            v = half_clean( v, _mm512_shuffle_epi32( v, (_MM_PERM_ENUM)_MM_SHUFFLE( 1, 0, 3, 2 ) ), 0xCCCC );
+            return half_clean( v, _mm512_shuffle_epi32( v, (_MM_PERM_ENUM)_MM_SHUFFLE( 2, 3, 0, 1 ) ), 0xAAAA );
+        }
+
+    public:
+        typedef int32_t value_type;
+        typedef __m512i vector;
+        enum { width = 16 };
+
+        PHAT_TARGET_AVX512 static vector load( const value_type* ptr ) { return _mm512_loadu_si512( (const void*)ptr ); }
+
+        PHAT_TARGET_AVX512 static void store( value_type* ptr, vector v ) { _mm512_storeu_si512( (void*)ptr, v ); }
+
+        PHAT_TARGET_AVX512 static value_type first( vector v ) { return _mm_cvtsi128_si32( _mm512_castsi512_si128( v ) ); }
+
+        PHAT_TARGET_AVX512 static value_type last( vector v ) { return _mm_extract_epi32( _mm512_extracti32x4_epi32( v, 3 ), 3 ); }
+
+        PHAT_TARGET_AVX512 static void merge( vector& lo, vector& hi ) {
+            hi = _mm512_permutexvar_epi32( _mm512_set_epi32( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 ), hi );
+            const __m512i new_lo = _mm512_min_epi32( lo, hi );
+            hi = sort_bitonic( _mm512_max_epi32( lo, hi ) );
+            lo = sort_bitonic( new_lo );
+        }
+
+        PHAT_TARGET_AVX512 static unsigned equal_to_next( vector v ) {
+            return _mm512_cmpeq_epi32_mask( v, _mm512_alignr_epi32( v, v, 1 ) ) & 0x7FFF;
+        }
+
+        PHAT_TARGET_AVX512 value_type* compress_store( value_type* out, unsigned keep, vector v ) const {
+            _mm512_mask_compressstoreu_epi32( out, (__mmask16)keep, v );
+            return out + _mm_popcnt_u32( keep );
+        }
+    };
+
+    // The two drivers only differ in their target attribute, which cannot depend on a template parameter.
+    #define PHAT_SYMMETRIC_DIFFERENCE_MERGE_NETWORK                                                                   \
+        typedef typename Ops::value_type T;                                                                           \
+        const int width = Ops::width;                                                                                 \
+        const unsigned all_lanes = ( 1u << width ) - 1;                                                               \
+        /* short columns are faster with the scalar merge */                                                          \
+        if( a_end - a < 2 * width || b_end - b < 2 * width )                                                          \
+            return symmetric_difference_scalar( a, a_end, b, b_end, out );                                            \
+        const Ops ops;                                                                                                \
+        typename Ops::vector lo = Ops::load( a );                                                                     \
+        typename Ops::vector hi = Ops::load( b );                                                                     \
+        a += width;                                                                                                   \
+        b += width;                                                                                                   \
+        T previous = 0;                                                                                               \
+        bool previous_written = false;                                                                                \
+        while( true ) {                                                                                               \
+            Ops::merge( lo, hi );                                                                                     \
+            const T head = Ops::first( lo );                                                                          \
+            const unsigned head_is_pair = previous_written && head == previous;                                       \
+            out -= head_is_pair;                                                                                      \
+            const unsigned equal = Ops::equal_to_next( lo );                                                          \
+            out = ops.compress_store( out, ~( equal | ( equal << 1 ) | head_is_pair ) & all_lanes, lo );              \
+            previous = Ops::last( lo );                                                                               \
+            previous_written = !( ( equal >> ( width - 2 ) ) & 1 );                                                   \
+            const bool take_a = a != a_end && ( b == b_end || *a <= *b );                                             \
+            const T* next = take_a ? a : b;                                                                           \
+            if( ( take_a ? a_end : b_end ) - next < width )                                                           \
+                break;                                                                                                \
+            lo = Ops::load( next );                                                                                   \
+            a += take_a ? width : 0;                                                                                  \
+            b += take_a ? 0 : width;                                                                                  \
+        }                                                                                                             \
+        T rest[ width + 1 ];                                                                                          \
+        T* rest_end = rest;                                                                                           \
+        if( previous_written ) {                                                                                      \
+            out--;                                                                                                    \
+            *rest_end++ = previous;                                                                                   \
+        }                                                                                                             \
+        Ops::store( rest_end, hi );                                                                                   \
+        out = symmetric_difference_drain( rest, rest_end + width, a, a_end, b, b_end, out );                          \
+        return symmetric_difference_scalar( a, a_end, b, b_end, out );
+
+    template< typename Ops >
+    PHAT_TARGET_AVX2 typename Ops::value_type* symmetric_difference_avx2( const typename Ops::value_type* a, const typename Ops::value_type* a_end,
+                                                                          const typename Ops::value_type* b, const typename Ops::value_type* b_end,
+                                                                          typename Ops::value_type* out ) {
+        PHAT_SYMMETRIC_DIFFERENCE_MERGE_NETWORK
+    }
+
+    // GCC's own avx512 intrinsics pass an undefined vector as the unused source of their masked builtins, which
+    // -Wmaybe-uninitialized reports wherever they are inlined (GCC bug 105593).
+    #if defined( __GNUC__ ) && !defined( __clang__ )
+        #pragma GCC diagnostic push
+        #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    #endif
+
+    template< typename Ops >
+    PHAT_TARGET_AVX512 typename Ops::value_type* symmetric_difference_avx512( const typename Ops::value_type* a, const typename Ops::value_type* a_end,
+                                                                              const typename Ops::value_type* b, const typename Ops::value_type* b_end,
+                                                                              typename Ops::value_type* out ) {
+        PHAT_SYMMETRIC_DIFFERENCE_MERGE_NETWORK
+    }
+
+    #if defined( __GNUC__ ) && !defined( __clang__ )
+        #pragma GCC diagnostic pop
+    #endif
+
+    #undef PHAT_SYMMETRIC_DIFFERENCE_MERGE_NETWORK
+#endif
+
+    enum simd_level { SIMD_NONE, SIMD_AVX2, SIMD_AVX512 };
+
+    // widest instruction set supported by the cpu we are running on
+    inline simd_level get_simd_level() {
+#ifdef PHAT_X86_SIMD
+        __builtin_cpu_init();
+        if( __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "popcnt" ) )
+            return SIMD_AVX512;
+        if( __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "popcnt" ) )
+            return SIMD_AVX2;
+#endif
+        return SIMD_NONE;
+    }
+
+    // picks the kernel for entries of type T -- the choice is made once per type
+    template< typename T >
+    struct symmetric_difference_kernel {
+        typedef T* ( *function )( const T*, const T*, const T*, const T*, T* );
+
+        static function select( simd_level ) {
+            return &symmetric_difference_scalar< T >;
+        }
+
+        static function get() {
+            static const function kernel = select( get_simd_level() );
+            return kernel;
+        }
+    };
+
+#ifdef PHAT_X86_SIMD
+    template<>
+    inline symmetric_difference_kernel< int64_t >::function symmetric_difference_kernel< int64_t >::select( simd_level level ) {
+        switch( level ) {
+        case SIMD_AVX512: return &symmetric_difference_avx512< avx512_ops_64 >;
+        case SIMD_AVX2: return &symmetric_difference_avx2< avx2_ops_64 >;
+        default: return &symmetric_difference_scalar< int64_t >;
+        }
+    }
+
+    template<>
+    inline symmetric_difference_kernel< int32_t >::function symmetric_difference_kernel< int32_t >::select( simd_level level ) {
+        switch( level ) {
+        case SIMD_AVX512: return &symmetric_difference_avx512< avx512_ops_32 >;
+        case SIMD_AVX2: return &symmetric_difference_avx2< avx2_ops_32 >;
+        default: return &symmetric_difference_scalar< int32_t >;
+        }
+    }
+#endif
+
+    // writes the symmetric difference of the sorted ranges [a, a_end) and [b, b_end) to 'out' and returns the end of the result
+    template< typename T >
+    T* symmetric_difference( const T* a, const T* a_end, const T* b, const T* b_end, T* out ) {
+        return symmetric_difference_kernel< T >::get()( a, a_end, b, b_end, out );
+    }
+}
@@ -0,0 +1,116 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "persistence_pairs.h"
+#include "boundary_matrix.h"
+#include "compute_persistence_pairs.h"
+#include "algorithms/twist_reduction.h"
+
+namespace phat {
+
+    // Persistence of a filtration that grows at its end. The boundary matrix is kept reduced, together with the
+    // lookup of its lowest ones, and columns appended later are reduced against the existing pivots only -- the
+    // columns reduced before never change. The first reduction uses 'ReductionAlgorithm', appended columns are
+    // reduced by the standard algorithm. The matrix grows geometrically, so it may have empty columns beyond
+    // get_num_cols().
+    template< typename Representation = bit_tree_pivot_column, typename ReductionAlgorithm = twist_reduction >
+    class incremental_reduction {
+
+    protected:
+        boundary_matrix< Representation > matrix;
+        std::vector< index > lowest_one_lookup;
+        persistence_pairs pairs;
+        index nr_columns;
+        index nr_reduced_columns;
+        dimension max_homology_dim;
+
+    public:
+        incremental_reduction() : nr_columns( 0 ), nr_reduced_columns( 0 ), max_homology_dim( -1 ) {}
+
+        // number of columns appended or loaded so far
+        index get_num_cols() const { return nr_columns; }
+
+        index get_num_reduced_cols() const { return nr_reduced_columns; }
+
+        // pairs of all reduced columns, in the order they were found
+        const persistence_pairs& get_persistence_pairs() const { return pairs; }
+
+        // The initial filtration can be loaded directly into this matrix (followed by restart()).
+        // Afterwards it holds the reduced columns.
+        boundary_matrix< Representation >& get_boundary_matrix() { return matrix; }
+
+        // starts over with the current content of the boundary matrix as the initial filtration
+        void restart() {
+            nr_columns = matrix.get_num_cols();
+            nr_reduced_columns = 0;
+            lowest_one_lookup.clear();
+            pairs.clear();
+        }
+
+        // appends a column at the end of the filtration; it is reduced by the next call of reduce()
+        void append_column( dimension dim, const column& col ) {
+            if( nr_columns == matrix.get_num_cols() )
+                matrix.set_num_cols( std::max( (index)16, 2 * nr_columns ) );
+            matrix.set_dim( nr_columns, dim );
+            matrix.set_col( nr_columns, col );
+            nr_columns++;
+        }
+
+        // Reduces the columns appended since the last call and appends their pairs to 'new_pairs'.
+        // A nonnegative 'max_homology_dim' restricts the pairs as in compute_persistence_pairs. Only the value
+        // of the first reduction after restart() counts, the appended columns are reduced with the same bound.
+        // Returns the number of new pairs.
+        index reduce( persistence_pairs& new_pairs, dimension max_homology_dim = -1 ) {
+            const index nr_pairs_before = pairs.get_num_pairs();
+            if( nr_reduced_columns == 0 ) {
+                this->max_homology_dim = max_homology_dim;
+                if( max_homology_dim >= 0 )
+                    compute_persistence_pairs< ReductionAlgorithm >( pairs, matrix, max_homology_dim );
+                else
+                    compute_persistence_pairs< ReductionAlgorithm >( pairs, matrix );
+                matrix.sync();
+                lowest_one_lookup.assign( nr_columns, -1 );
+                for( index idx = 0; idx < pairs.get_num_pairs(); idx++ )
+                    lowest_one_lookup[ pairs.get_pair( idx ).first ] = pairs.get_pair( idx ).second;
+            } else {
+                lowest_one_lookup.resize( nr_columns, -1 );
+                for( index cur_col = nr_reduced_columns; cur_col < nr_columns; cur_col++ ) {
+                    if( this->max_homology_dim >= 0 && matrix.get_dim( cur_col ) > this->max_homology_dim + 1 ) {
+                        matrix.clear( cur_col );
+                        continue;
+                    }
+                    index lowest_one = matrix.get_max_index( cur_col );
+                    while( lowest_one != -1 && lowest_one_lookup[ lowest_one ] != -1 ) {
+                        matrix.add_to( lowest_one_lookup[ lowest_one ], cur_col );
+                        lowest_one = matrix.get_max_index( cur_col );
+                    }
+                    if( lowest_one != -1 ) {
+                        lowest_one_lookup[ lowest_one ] = cur_col;
+                        pairs.append_pair( lowest_one, cur_col );
+                    }
+                    matrix.finalize( cur_col );
+                }
+                matrix.sync();
+            }
+            nr_reduced_columns = nr_columns;
+
+            for( index idx = nr_pairs_before; idx < pairs.get_num_pairs(); idx++ )
+                new_pairs.append_pair( pairs.get_pair( idx ).first, pairs.get_pair( idx ).second );
+            return pairs.get_num_pairs() - nr_pairs_before;
+        }
+    };
+}
@@ -0,0 +1,97 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "helpers/misc.h"
+#include "persistence_pairs.h"
+
+namespace phat {
+    // All persistence intervals of a filtration: dimension, birth and death of every finite interval, and the
+    // birth of every essential class, whose death is -1. If filtration values were given, births and deaths are
+    // also available as values -- the death value of an essential class is infinity.
+    class persistence_diagram {
+
+    protected:
+        std::vector< dimension > dims;
+        std::vector< index > births;
+        std::vector< index > deaths;
+        std::vector< double > birth_values;
+        std::vector< double > death_values;
+
+    public:
+        index get_num_intervals() const { return (index)births.size(); }
+
+        dimension get_dim( index idx ) const { return dims[ idx ]; }
+
+        index get_birth( index idx ) const { return births[ idx ]; }
+
+        index get_death( index idx ) const { return deaths[ idx ]; }
+
+        bool is_essential( index idx ) const { return deaths[ idx ] == -1; }
+
+        bool has_values() const { return !birth_values.empty(); }
+
+        double get_birth_value( index idx ) const { return birth_values[ idx ]; }
+
+        double get_death_value( index idx ) const { return death_values[ idx ]; }
+
+        // 'filtration_values' holds one value per column, or is null
+        void append_interval( dimension dim, index birth, index death, const double* filtration_values = 0 ) {
+            dims.push_back( dim );
+            births.push_back( birth );
+            deaths.push_back( death );
+            if( filtration_values ) {
+                birth_values.push_back( filtration_values[ birth ] );
+                death_values.push_back( death == -1 ? std::numeric_limits< double >::infinity() : filtration_values[ death ] );
+            }
+        }
+
+        // the values are reserved as well if the diagram has values or 'with_values' is set
+        void reserve( index nr_intervals, bool with_values = false ) {
+            dims.reserve( nr_intervals );
+            births.reserve( nr_intervals );
+            deaths.reserve( nr_intervals );
+            if( with_values || has_values() ) {
+                birth_values.reserve( nr_intervals );
+                death_values.reserve( nr_intervals );
+            }
+        }
+
+        void clear() {
+            dims.clear();
+            births.clear();
+            deaths.clear();
+            birth_values.clear();
+            death_values.clear();
+        }
+
+        void reverse() {
+            std::reverse( dims.begin(), dims.end() );
+            std::reverse( births.begin(), births.end() );
+            std::reverse( deaths.begin(), deaths.end() );
+            std::reverse( birth_values.begin(), birth_values.end() );
+            std::reverse( death_values.begin(), death_values.end() );
+        }
+
+        // the finite intervals as persistence_pairs
+        void get_persistence_pairs( persistence_pairs& pairs ) const {
+            pairs.clear();
+            for( index idx = 0; idx < get_num_intervals(); idx++ )
+                if( !is_essential( idx ) )
+                    pairs.append_pair( births[ idx ], deaths[ idx ] );
+        }
+    };
+}
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "helpers/misc.h"
+#include "helpers/compact_format.h"
 
 namespace phat {
     class persistence_pairs {
@@ -132,6 +133,49 @@ namespace phat {
             return true;
         }
 
+        // Loads the persistence pairs from given file in compact format (see helpers/compact_format.h)
+        bool load_compact( std::string filename ) {
+            mapped_compact_file input;
+            if( !input.open( filename, COMPACT_PERSISTENCE_PAIRS ) )
+                return false;
+
+            pairs.resize( input.get_num_items() );
+            bool is_valid = true;
+            #pragma omp parallel for schedule( dynamic, 1 ) reduction( && : is_valid )
+            for( index block_id = 0; block_id < input.get_num_blocks(); block_id++ ) {
+                const unsigned char* pos = input.get_block_begin( block_id );
+                const unsigned char* block_end = input.get_block_end( block_id );
+                index previous_birth = 0;
+                for( index idx = input.get_first_item( block_id ); is_valid && idx < input.get_first_item( block_id + 1 ); idx++ ) {
+                    is_valid = read_compact_pair( pos, block_end, previous_birth, pairs[ idx ].first, pairs[ idx ].second );
+                    previous_birth = pairs[ idx ].first;
+                }
+                if( pos != block_end )
+                    is_valid = false;
+            }
+            if( !is_valid )
+                pairs.clear();
+            return is_valid;
+        }
+
+        // Saves the persistence pairs to given file in compact format (see helpers/compact_format.h)
+        bool save_compact( std::string filename ) {
+            this->sort();
+            const index nr_pairs = get_num_pairs();
+            const index nr_blocks = ( nr_pairs + compact_block_size - 1 ) / compact_block_size;
+            std::vector< compact_block > blocks( nr_blocks );
+            #pragma omp parallel for schedule( dynamic, 1 )
+            for( index block_id = 0; block_id < nr_blocks; block_id++ ) {
+                const index block_end = std::min( ( block_id + 1 ) * (index)compact_block_size, nr_pairs );
+                index previous_birth = 0;
+                for( index idx = block_id * compact_block_size; idx < block_end; idx++ ) {
+                    append_compact_pair( blocks[ block_id ], previous_birth, pairs[ idx ].first, pairs[ idx ].second );
+                    previous_birth = pairs[ idx ].first;
+                }
+            }
+            return save_compact_file( filename, COMPACT_PERSISTENCE_PAIRS, nr_pairs, compact_block_size, blocks );
+        }
+
         bool operator==( persistence_pairs& other_pairs ) {
             this->sort();
             other_pairs.sort();
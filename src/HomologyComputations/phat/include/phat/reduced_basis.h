@@ -0,0 +1,156 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "helpers/misc.h"
+#include "helpers/symmetric_difference.h"
+#include "boundary_matrix.h"
+#include "transform_matrix.h"
+
+namespace phat {
+
+    // Exhaustively reduced columns of a reduced boundary matrix, as compressed columns (see helpers/compressed_columns.h).
+    // Every non-zero column j is reduced further against the columns before it, until, apart from its own lowest one,
+    // none of its rows is the lowest one of a column before j. This column is the same whichever algorithm reduced
+    // the matrix, and it is a representative cycle of the class it kills. Each column only reads the reduced columns before it, which do not
+    // change, so the columns are reduced in parallel. Afterwards a representative is a copy of a single column.
+    class reduced_basis {
+
+    protected:
+        enum { block_size = 1024 };
+
+        std::vector< index > offsets;
+        std::vector< index > entries;
+        std::vector< index > deaths;    // column whose lowest one is the given row, -1 otherwise
+
+        // Turns the column sizes in offsets[ 1 ], ..., offsets[ nr_columns ] into offsets and copies the columns of
+        // each block of 'block_size' columns, stored back to back in blocks[ block_id ], to their place in 'entries'.
+        static void concatenate_blocks( std::vector< column >& blocks, std::vector< index >& offsets, std::vector< index >& entries ) {
+            const index nr_columns = (index)offsets.size() - 1;
+            for( index idx = 0; idx < nr_columns; idx++ )
+                offsets[ idx + 1 ] += offsets[ idx ];
+            entries.resize( offsets[ nr_columns ] );
+            #pragma omp parallel for schedule( dynamic, 1 )
+            for( index block_id = 0; block_id < (index)blocks.size(); block_id++ ) {
+                std::copy( blocks[ block_id ].begin(), blocks[ block_id ].end(), entries.begin() + offsets[ block_id * block_size ] );
+                column().swap( blocks[ block_id ] );
+            }
+        }
+
+        // reduces 'col', a cycle ending in column 'idx' or its lowest one, against the reduced columns before 'idx'
+        void reduce_col( index idx, const std::vector< index >& source_offsets, const std::vector< index >& source_entries,
+                         column& col, column& temp_col ) const {
+            for( index pos = (index)col.size() - 2; pos >= 0; pos-- ) {
+                const index owner = deaths[ col[ pos ] ];
+                if( owner == -1 || owner >= idx )
+                    continue;
+                // the column of 'owner' ends in col[ pos ], so only the entries up to 'pos' change
+                const index* owner_begin = source_entries.data() + source_offsets[ owner ];
+                const index* owner_end = source_entries.data() + source_offsets[ owner + 1 ];
+                temp_col.resize( col.size() + ( owner_end - owner_begin ) );
+                index* prefix_end = symmetric_difference( col.data(), col.data() + pos + 1, owner_begin, owner_end, temp_col.data() );
+                const index prefix_size = prefix_end - temp_col.data();
+                prefix_end = std::copy( col.begin() + pos + 1, col.end(), prefix_end );
+                temp_col.resize( prefix_end - temp_col.data() );
+                col.swap( temp_col );
+                pos = prefix_size;
+            }
+        }
+
+    public:
+        // 'reduced_matrix' has to be reduced and synced. If 'transform' holds its V (see compute_persistence_pairs),
+        // the representatives of the essential classes are stored as well, in the (empty) columns of their births.
+        template< typename Representation >
+        void init( const boundary_matrix< Representation >& reduced_matrix, const transform_matrix* transform = 0 ) {
+            const index nr_columns = reduced_matrix.get_num_cols();
+            const index nr_blocks = ( nr_columns + block_size - 1 ) / block_size;
+
+            deaths.assign( nr_columns, -1 );
+            #pragma omp parallel for
+            for( index cur_col = 0; cur_col < nr_columns; cur_col++ )
+                if( !reduced_matrix.is_empty( cur_col ) )
+                    deaths[ reduced_matrix.get_max_index( cur_col ) ] = cur_col;
+
+            // the reduced matrix and the essential columns of V, compressed
+            std::vector< index > source_offsets( nr_columns + 1, 0 );
+            std::vector< index > source_entries;
+            std::vector< column > blocks( nr_blocks );
+            column temp_col;
+            #pragma omp parallel for schedule( dynamic, 1 ) private( temp_col )
+            for( index block_id = 0; block_id < nr_blocks; block_id++ ) {
+                const index block_end = std::min( ( block_id + 1 ) * (index)block_size, nr_columns );
+                for( index cur_col = block_id * block_size; cur_col < block_end; cur_col++ ) {
+                    reduced_matrix.get_col( cur_col, temp_col );
+                    if( temp_col.empty() && transform && deaths[ cur_col ] == -1 )
+                        transform->get_col( cur_col, temp_col );
+                    source_offsets[ cur_col + 1 ] = (index)temp_col.size();
+                    blocks[ block_id ].insert( blocks[ block_id ].end(), temp_col.begin(), temp_col.end() );
+                }
+            }
+            concatenate_blocks( blocks, source_offsets, source_entries );
+
+            // the exhaustive reduction
+            offsets.assign( nr_columns + 1, 0 );
+            blocks.assign( nr_blocks, column() );
+            column cur_col_entries;
+            #pragma omp parallel for schedule( dynamic, 1 ) private( temp_col, cur_col_entries )
+            for( index block_id = 0; block_id < nr_blocks; block_id++ ) {
+                const index block_end = std::min( ( block_id + 1 ) * (index)block_size, nr_columns );
+                for( index cur_col = block_id * block_size; cur_col < block_end; cur_col++ ) {
+                    cur_col_entries.assign( source_entries.begin() + source_offsets[ cur_col ], source_entries.begin() + source_offsets[ cur_col + 1 ] );
+                    reduce_col( cur_col, source_offsets, source_entries, cur_col_entries, temp_col );
+                    offsets[ cur_col + 1 ] = (index)cur_col_entries.size();
+                    blocks[ block_id ].insert( blocks[ block_id ].end(), cur_col_entries.begin(), cur_col_entries.end() );
+                }
+            }
+            concatenate_blocks( blocks, offsets, entries );
+        }
+
+        index get_num_cols() const { return (index)deaths.size(); }
+
+        // total number of stored entries
+        index get_num_entries() const { return (index)entries.size(); }
+
+        // replaces(!) content of 'col' with the exhaustively reduced column 'idx'
+        void get_col( index idx, column& col ) const {
+            col.assign( entries.begin() + offsets[ idx ], entries.begin() + offsets[ idx + 1 ] );
+        }
+
+        // the column killing the class born at 'birth', -1 otherwise
+        index get_death( index birth ) const { return deaths[ birth ]; }
+
+        // Replaces(!) content of 'cycle' with the representative of the class born at 'birth'. Returns false if there
+        // is none, i.e., 'birth' is a death or an essential class whose cycle was not recorded.
+        bool get_representative_cycle( index birth, column& cycle ) const {
+            const index idx = deaths[ birth ] != -1 ? deaths[ birth ] : birth;
+            if( offsets[ idx ] == offsets[ idx + 1 ] || ( idx == birth && entries[ offsets[ idx + 1 ] - 1 ] != birth ) ) {
+                cycle.clear();
+                return false;
+            }
+            get_col( idx, cycle );
+            return true;
+        }
+    };
+
+    // reduces 'boundary_matrix' by 'ReductionAlgorithm' and exhaustively reduces the result into 'basis'
+    template< typename ReductionAlgorithm, typename Representation >
+    void compute_reduced_basis( reduced_basis& basis, boundary_matrix< Representation >& boundary_matrix ) {
+        ReductionAlgorithm reduce;
+        reduce( boundary_matrix );
+        boundary_matrix.sync();
+        basis.init( boundary_matrix );
+    }
+}
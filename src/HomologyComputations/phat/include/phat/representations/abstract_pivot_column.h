@@ -26,13 +26,15 @@ namespace phat {
     // Note: We could even make the rep generic in the underlying Const representation
     //       But I cannot imagine that anything else than vector<vector<index>> would
     //       make sense
-    template< typename PivotColumn >
-    class abstract_pivot_column : public vector_vector {
+    template< typename PivotColumn, typename IndexType = index >
+    class abstract_pivot_column : public basic_vector_vector< IndexType > {
         
     protected:
-        typedef vector_vector Base;
+        typedef basic_vector_vector< IndexType > Base;
         typedef PivotColumn pivot_col;
 
+        using Base::matrix;
+
         // For parallization purposes, it could be more than one full column
         mutable thread_local_storage< pivot_col > pivot_cols;
         mutable thread_local_storage< index > idx_of_pivot_cols;
@@ -95,8 +97,11 @@ namespace phat {
 
         void _remove_max( index idx ) {	is_pivot_col( idx ) ? get_pivot_col().remove_max() : Base::_remove_max( idx ); }
         
-        void finalize( index idx ) { Base::_finalize( idx ); }
+        // writes the pivot column back, so that other threads can read it
+        void _finalize( index idx ) {
+            if( is_pivot_col( idx ) )
+                release_pivot_col();
+            Base::_finalize( idx );
+        }
     };
 }
-
-
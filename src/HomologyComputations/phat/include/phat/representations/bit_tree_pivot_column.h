@@ -26,7 +26,7 @@ namespace phat {
     // This is a bitset indexed with a 64-ary tree. Each node in the index
     // has 64 bits; i-th bit says that the i-th subtree is non-empty.
     // Supports practically O(1), inplace, zero-allocation: insert, remove, max_element
-    // and clear in O(number of ones in the bitset).
+    // and clear in O(number of words that contain ones in the bitset).
     // 'add_index' is still the real bottleneck in practice.
     class bit_tree_column
     {
@@ -36,19 +36,74 @@ namespace phat {
         typedef uint64_t block_type;
         std::vector< block_type > data;
 
-        
-        size_t debrujin_magic_table[ 64 ];
-
         enum { block_size_in_bits = 64 };
         enum { block_shift = 6 };
 
-        // Some magic: http://graphics.stanford.edu/~seander/bithacks.html
-        // Gets the position of the rightmost bit of 'x'. 0 means the most significant bit. 
-        // (-x)&x isolates the rightmost bit.
-        // The whole method is much faster than calling log2i, and very comparable to using ScanBitForward/Reverse intrinsic,
-        // which should be one CPU instruction, but is not portable.
-        size_t rightmost_pos( const block_type value ) const {                
-            return 64 - 1 - debrujin_magic_table[ ( (value & (-(int64_t)value) ) * 0x07EDD5E59A4E28C2 ) >> 58 ];
+        // Position of the most significant set bit of 'value' != 0 -- bit i of a block stands for its i-th child.
+        // Compiles to a single bsr/lzcnt instruction where available.
+        static size_t highest_bit( const block_type value ) {
+#if defined( __GNUC__ )
+            return block_size_in_bits - 1 - __builtin_clzll( value );
+#elif defined( _MSC_VER ) && defined( _M_X64 )
+            unsigned long pos;
+            _BitScanReverse64( &pos, value );
+            return pos;
+#else
+            size_t pos = 0;
+            block_type rest = value;
+            for( size_t shift = block_size_in_bits / 2; shift > 0; shift >>= 1 )
+                if( rest >> shift ) {
+                    rest >>= shift;
+                    pos += shift;
+                }
+            return pos;
+#endif
+        }
+
+        // Position of the least significant set bit of 'value' != 0
+        static size_t lowest_bit( const block_type value ) {
+#if defined( __GNUC__ )
+            return __builtin_ctzll( value );
+#elif defined( _MSC_VER ) && defined( _M_X64 )
+            unsigned long pos;
+            _BitScanForward64( &pos, value );
+            return pos;
+#else
+            return highest_bit( value & ( ~value + 1 ) );
+#endif
+        }
+
+        static size_t count_bits( const block_type value ) {
+#if defined( __GNUC__ )
+            return __builtin_popcountll( value );
+#else
+            size_t count = 0;
+            for( block_type rest = value; rest; rest &= rest - 1 )
+                count++;
+            return count;
+#endif
+        }
+
+        // Appends the indices below node 'address' in increasing order, one word at a time.
+        // The visited nodes are zeroed if 'clear_nodes' is set.
+        template< bool clear_nodes, typename Column >
+        void collect( const size_t address, Column* out ) {
+            block_type block = data[ address ];
+            if( clear_nodes )
+                data[ address ] = 0;
+
+            if( address >= offset ) {
+                if( out ) {
+                    const typename Column::value_type first_index = (typename Column::value_type)( ( address - offset ) << block_shift );
+                    size_t pos = out->size();
+                    out->resize( pos + count_bits( block ) );
+                    for( ; block; block &= block - 1 )
+                        ( *out )[ pos++ ] = first_index + (typename Column::value_type)lowest_bit( block );
+                }
+            } else {
+                for( ; block; block &= block - 1 )
+                    collect< clear_nodes >( ( address << block_shift ) + lowest_bit( block ) + 1, out );
+            }
         }
 
     public:        
@@ -64,20 +119,12 @@ namespace phat {
                 upper_blocks += n;
             }
 
+            // an empty tree of the same shape is kept as it is, e.g. when a matrix of the same size is reloaded
+            if( !data.empty() && !data[ 0 ] && offset == (size_t)upper_blocks && data.size() == (size_t)( upper_blocks + bottom_blocks_needed ) )
+                return;
+
             offset = upper_blocks;
-            data.resize( upper_blocks + bottom_blocks_needed, 0 );
-
-            std::size_t temp_array[ 64 ] = {
-                    63,  0, 58,  1, 59, 47, 53,  2,
-                    60, 39, 48, 27, 54, 33, 42,  3,
-                    61, 51, 37, 40, 49, 18, 28, 20,
-                    55, 30, 34, 11, 43, 14, 22,  4,
-                    62, 57, 46, 52, 38, 26, 32, 41,
-                    50, 36, 17, 19, 29, 10, 13, 21,
-                    56, 45, 25, 31, 35, 16,  9, 12,
-                    44, 24, 15,  8, 23,  7,  6,  5 };
-
-            std::copy( &temp_array[ 0 ], &temp_array[ 64 ], &debrujin_magic_table[ 0 ] );
+            data.assign( upper_blocks + bottom_blocks_needed, 0 );
         }
 
         index get_max_index() const {
@@ -89,7 +136,7 @@ namespace phat {
             size_t index = 0;
             while( newn < data.size() ) {
                 n = newn;
-                index = rightmost_pos( data[ n ] );
+                index = highest_bit( data[ n ] );
                 newn = ( n << block_shift ) + index + 1;
             } 
 
@@ -107,7 +154,7 @@ namespace phat {
             size_t address = index_in_level + offset;
             size_t index_in_block = entry & block_modulo_mask;
 
-            block_type mask = ( ONE << ( block_size_in_bits - index_in_block - 1 ) );
+            block_type mask = ( ONE << index_in_block );
 
             data[ address ] ^= mask;
 
@@ -117,33 +164,27 @@ namespace phat {
                 index_in_level >>= block_shift;
                 --address;
                 address >>= block_shift;
-                mask = ( ONE << ( block_size_in_bits - index_in_block - 1 ) );
+                mask = ( ONE << index_in_block );
                 data[ address ] ^= mask;
             }
         }
 
-        void get_col_and_clear( column &out ) {
-            index mx = this->get_max_index();
-            while( mx != -1 ) {
-                out.push_back( mx );
-                add_index( mx );
-                mx = this->get_max_index();
-            }
-
-            std::reverse( out.begin(), out.end() );
+        // appends the indices in increasing order and empties the bitset, touching only non-zero words
+        template< typename Column >
+        void get_col_and_clear( Column &out ) {
+            if( data[ 0 ] )
+                collect< true >( 0, &out );
         }
 
-        void add_col(const column &col) {
+        template< typename Column >
+        void add_col(const Column &col) {
             for( size_t i = 0; i < col.size(); ++i )
                 add_index(col[i]);
         }
 
 		void clear() {
-            index mx = this->get_max_index();
-            while( mx != -1 ) {
-                add_index( mx );
-                mx = this->get_max_index();
-            }
+            if( data[ 0 ] )
+                collect< true, column >( 0, 0 );
         }
 
 		void remove_max() {
@@ -156,10 +197,12 @@ namespace phat {
         }
 
         void get_col( column& col ) {
-            get_col_and_clear( col );
-            add_col( col );
+            col.clear();
+            if( data[ 0 ] )
+                collect< false >( 0, &col );
         }
     };
 
     typedef abstract_pivot_column<bit_tree_column> bit_tree_pivot_column;
+    typedef abstract_pivot_column<bit_tree_column, int32_t> bit_tree_pivot_column_32;
 }
@@ -0,0 +1,300 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "../helpers/misc.h"
+#include "../helpers/symmetric_difference.h"
+
+namespace phat {
+
+    // Append-only storage for column entries. Blocks are never reallocated, so pointers into
+    // them stay valid until the owning compressed_sparse_column compacts its arenas.
+    template< typename IndexType >
+    class index_arena {
+
+    protected:
+        enum { min_block_size = 1 << 10 };
+        enum { max_block_size = 1 << 22 };
+
+        typedef std::vector< IndexType > block;
+
+        std::deque< block > blocks;
+        index used_in_last_block;
+        index total_used;
+        index total_garbage;
+
+    public:
+        index_arena() : used_in_last_block( 0 ), total_used( 0 ), total_garbage( 0 ) {}
+
+        // true iff 'size' more entries fit into the current block
+        bool fits( index size ) const {
+            return !blocks.empty() && used_in_last_block + size <= (index)blocks.back().size();
+        }
+
+        // returns room for 'size' consecutive entries
+        IndexType* allocate( index size ) {
+            if( !fits( size ) ) {
+                index new_block_size = blocks.empty() ? (index)min_block_size : 2 * (index)blocks.back().size();
+                new_block_size = std::min( std::max( new_block_size, (index)min_block_size ), (index)max_block_size );
+                blocks.push_back( block( std::max( new_block_size, size ) ) );
+                used_in_last_block = 0;
+            }
+            IndexType* result = &blocks.back()[ 0 ] + used_in_last_block;
+            used_in_last_block += size;
+            total_used += size;
+            return result;
+        }
+
+        // hands the last 'size' entries of the most recent allocation back to the arena
+        void shrink_last( index size ) {
+            used_in_last_block -= size;
+            total_used -= size;
+        }
+
+        // records that 'size' entries somewhere in the matrix are no longer referenced
+        void add_garbage( index size ) {
+            total_garbage += size;
+        }
+
+        // adopts 'block' as a completely filled block
+        void adopt( block& new_block ) {
+            blocks.push_back( block() );
+            blocks.back().swap( new_block );
+            used_in_last_block = (index)blocks.back().size();
+            total_used += used_in_last_block;
+        }
+
+        index get_used() const { return total_used; }
+
+        index get_garbage() const { return total_garbage; }
+
+        void release() {
+            blocks.clear();
+            used_in_last_block = 0;
+            total_used = 0;
+            total_garbage = 0;
+        }
+    };
+
+    // Compressed sparse column storage: the sorted entries of all columns live in large index arenas,
+    // and a column is just a (begin, size) pair pointing into one of them.
+    // Column additions append their result to the side arena of the calling thread and leave the old
+    // target entries behind as garbage. Once the garbage outweighs the live entries, all columns are
+    // compacted into a single contiguous arena, ordered by column index.
+    template< typename IndexType = index >
+    class basic_compressed_sparse_column {
+
+    public:
+        typedef IndexType index_type;
+
+    protected:
+        std::vector< dimension > dims;
+        std::vector< index_type* > col_begins;
+        std::vector< index > col_sizes;
+
+        thread_local_storage< index_arena< index_type > > arenas;
+
+    protected:
+        index_type* _get_begin( index idx ) const {
+            return col_begins[ idx ];
+        }
+
+        index_type* _get_end( index idx ) const {
+            return col_begins[ idx ] + col_sizes[ idx ];
+        }
+
+        // true iff the garbage of all arenas outweighs the live entries
+        bool _has_too_much_garbage() const {
+            index used = 0;
+            index garbage = 0;
+            for( int tid = 0; tid < omp_get_max_threads(); tid++ ) {
+                used += arenas[ tid ].get_used();
+                garbage += arenas[ tid ].get_garbage();
+            }
+            return 2 * garbage > used;
+        }
+
+        // moves all columns into one contiguous block -- must not be called from a parallel region
+        void _compact() {
+            const index nr_of_columns = _get_num_cols();
+            std::vector< index > new_offsets( nr_of_columns + 1, 0 );
+            for( index idx = 0; idx < nr_of_columns; idx++ )
+                new_offsets[ idx + 1 ] = new_offsets[ idx ] + col_sizes[ idx ];
+
+            std::vector< index_type > new_block( new_offsets[ nr_of_columns ] );
+            #pragma omp parallel for
+            for( index idx = 0; idx < nr_of_columns; idx++ )
+                std::copy( _get_begin( idx ), _get_end( idx ), new_block.begin() + new_offsets[ idx ] );
+
+            for( int tid = 0; tid < omp_get_max_threads(); tid++ )
+                arenas[ tid ].release();
+
+            index_type* new_begin = new_block.empty() ? 0 : &new_block[ 0 ];
+            for( index idx = 0; idx < nr_of_columns; idx++ )
+                col_begins[ idx ] = new_begin + new_offsets[ idx ];
+            arenas[ 0 ].adopt( new_block );
+        }
+
+        static void _take_entries( std::vector< index >& entries, std::vector< index >& block ) {
+            block.swap( entries );
+        }
+
+        template< typename OtherIndexType >
+        static void _take_entries( std::vector< index >& entries, std::vector< OtherIndexType >& block ) {
+            block.assign( entries.begin(), entries.end() );
+            std::vector< index >().swap( entries );
+        }
+
+    public:
+        basic_compressed_sparse_column() {}
+
+        // columns point into the arenas of their owner, so copies have to rebuild them
+        basic_compressed_sparse_column( const basic_compressed_sparse_column& other ) {
+            *this = other;
+        }
+
+        basic_compressed_sparse_column& operator=( const basic_compressed_sparse_column& other ) {
+            if( this != &other ) {
+                for( int tid = 0; tid < omp_get_max_threads(); tid++ )
+                    arenas[ tid ].release();
+                dims = other.dims;
+                col_sizes = other.col_sizes;
+                col_begins = other.col_begins;
+                _compact();
+            }
+            return *this;
+        }
+
+        // replaces all columns by the given compressed columns; the entries are taken over without a copy
+        // if they already have the stored index type
+        void _load_compressed( std::vector< dimension >& new_dims, std::vector< index >& offsets, std::vector< index >& entries ) {
+            for( int tid = 0; tid < omp_get_max_threads(); tid++ )
+                arenas[ tid ].release();
+            const index nr_of_columns = (index)new_dims.size();
+            dims.swap( new_dims );
+            col_begins.resize( nr_of_columns );
+            col_sizes.resize( nr_of_columns );
+
+            std::vector< index_type > new_block;
+            _take_entries( entries, new_block );
+            index_type* new_begin = new_block.empty() ? 0 : &new_block[ 0 ];
+            #pragma omp parallel for
+            for( index idx = 0; idx < nr_of_columns; idx++ ) {
+                col_begins[ idx ] = new_begin + offsets[ idx ];
+                col_sizes[ idx ] = offsets[ idx + 1 ] - offsets[ idx ];
+            }
+            arenas[ 0 ].adopt( new_block );
+            std::vector< dimension >().swap( new_dims );
+            std::vector< index >().swap( offsets );
+        }
+
+        // overall number of cells in boundary_matrix
+        index _get_num_cols() const {
+            return (index)col_sizes.size();
+        }
+        void _set_num_cols( index nr_of_columns ) {
+            dims.resize( nr_of_columns );
+            col_begins.resize( nr_of_columns, 0 );
+            col_sizes.resize( nr_of_columns, 0 );
+        }
+
+        // dimension of given index
+        dimension _get_dim( index idx ) const {
+            return dims[ idx ];
+        }
+        void _set_dim( index idx, dimension dim ) {
+            dims[ idx ] = dim;
+        }
+
+        // replaces(!) content of 'col' with boundary of given index
+        void _get_col( index idx, column& col ) const {
+            col.assign( _get_begin( idx ), _get_end( idx ) );
+        }
+        void _set_col( index idx, const column& col ) {
+            const index new_size = (index)col.size();
+            index_arena< index_type >& arena = arenas();
+            if( new_size > col_sizes[ idx ] ) {
+                arena.add_garbage( col_sizes[ idx ] );
+                col_begins[ idx ] = arena.allocate( new_size );
+            } else {
+                arena.add_garbage( col_sizes[ idx ] - new_size );
+            }
+            std::copy( col.begin(), col.end(), col_begins[ idx ] );
+            col_sizes[ idx ] = new_size;
+        }
+
+        // true iff boundary of given idx is empty
+        bool _is_empty( index idx ) const {
+            return col_sizes[ idx ] == 0;
+        }
+
+        // largest row index of given column idx (new name for lowestOne())
+        index _get_max_index( index idx ) const {
+            return col_sizes[ idx ] == 0 ? -1 : col_begins[ idx ][ col_sizes[ idx ] - 1 ];
+        }
+
+        // removes the maximal index of a column
+        void _remove_max( index idx ) {
+            col_sizes[ idx ]--;
+            arenas().add_garbage( 1 );
+        }
+
+        // clears given column
+        void _clear( index idx ) {
+            arenas().add_garbage( col_sizes[ idx ] );
+            col_sizes[ idx ] = 0;
+        }
+
+        // syncronizes all data structures (essential for openmp stuff)
+        void _sync() {
+            if( _has_too_much_garbage() )
+                _compact();
+        }
+
+        // adds column 'source' to column 'target'
+        void _add_to( index source, index target ) {
+            index_arena< index_type >& arena = arenas();
+            const index max_size = col_sizes[ source ] + col_sizes[ target ];
+
+            // compaction moves every column, so only do it when no other thread can hold on to one
+            if( !arena.fits( max_size ) && omp_get_num_threads() == 1 && _has_too_much_garbage() )
+                _compact();
+
+            index_type* new_begin = arena.allocate( max_size );
+            index_type* new_end = symmetric_difference( _get_begin( target ), _get_end( target ),
+                                                        _get_begin( source ), _get_end( source ),
+                                                        new_begin );
+            const index new_size = (index)( new_end - new_begin );
+            arena.shrink_last( max_size - new_size );
+            arena.add_garbage( col_sizes[ target ] );
+            col_begins[ target ] = new_begin;
+            col_sizes[ target ] = new_size;
+        }
+
+        // finalizes given column -- entries never move outside of compaction, so nothing to do
+        void _finalize( index /*idx*/ ) {
+        }
+    };
+
+    // takes the compressed buffer over instead of copying it column by column
+    template< typename IndexType >
+    void load_compressed_columns( basic_compressed_sparse_column< IndexType >& rep, std::vector< dimension >& dims, std::vector< index >& offsets, std::vector< index >& entries ) {
+        rep._load_compressed( dims, offsets, entries );
+    }
+
+    typedef basic_compressed_sparse_column< index > compressed_sparse_column;
+    typedef basic_compressed_sparse_column< int32_t > compressed_sparse_column_32;
+}
@@ -35,7 +35,8 @@ namespace phat {
             is_in_history.resize( total_size, false );
         }
 
-        void add_col( const column& col ) {
+        template< typename Column >
+        void add_col( const Column& col ) {
             for( index idx = 0; idx < (index) col.size(); idx++ ) {
                 add_index( col[ idx ] );
             }
@@ -64,9 +65,10 @@ namespace phat {
             return -1;
         }
 
-        void get_col_and_clear( column& col ) {
+        template< typename Column >
+        void get_col_and_clear( Column& col ) {
             while( !is_empty() ) {
-                col.push_back( get_max_index() );
+                col.push_back( (typename Column::value_type)get_max_index() );
                 add_index( get_max_index() );
             }
             std::reverse( col.begin(), col.end() );
@@ -97,4 +99,5 @@ namespace phat {
     };
 
     typedef abstract_pivot_column< full_column > full_pivot_column;
+    typedef abstract_pivot_column< full_column, int32_t > full_pivot_column_32;
 }
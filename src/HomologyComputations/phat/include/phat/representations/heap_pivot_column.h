@@ -71,7 +71,8 @@ namespace phat {
             clear();
         }
 
-        void add_col( const column& col ) {
+        template< typename Column >
+        void add_col( const Column& col ) {
             for( index idx = 0; idx < (index) col.size(); idx++ )
                 data.push( col[ idx ] );
             inserts_since_last_prune += col.size( );
@@ -89,11 +90,12 @@ namespace phat {
             }
         }
 
-        void get_col_and_clear( column& col ) {
+        template< typename Column >
+        void get_col_and_clear( Column& col ) {
             col.clear();
             index max_index = pop_max_index( );
             while( max_index != -1 ) {
-                col.push_back( max_index );
+                col.push_back( (typename Column::value_type)max_index );
                 max_index = pop_max_index( );
             }
             std::reverse( col.begin(), col.end() );
@@ -123,4 +125,5 @@ namespace phat {
     };
 
     typedef abstract_pivot_column< heap_column > heap_pivot_column;
+    typedef abstract_pivot_column< heap_column, int32_t > heap_pivot_column_32;
 }
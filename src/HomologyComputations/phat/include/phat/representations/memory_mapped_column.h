@@ -0,0 +1,150 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "../helpers/misc.h"
+#include "../helpers/mapped_file.h"
+#include "../helpers/symmetric_difference.h"
+
+namespace phat {
+
+    // Columns are served straight from a binary file that is mapped into memory. A column gets its own
+    // storage only when it is modified (copy-on-write), so loading costs one pass over the column headers
+    // and the pages of columns that are never touched are never copied.
+    // Row indices are stored as in the file, i.e., as int64, so there is no 32-bit variant.
+    class memory_mapped_column {
+
+    public:
+        typedef index index_type;
+
+    protected:
+        std::shared_ptr< const mapped_binary_matrix > input;
+
+        std::vector< dimension > dims;
+        std::vector< char > is_mapped;     // true iff the column still lives in the mapped file
+        std::vector< index > mapped_sizes; // number of leading rows of the mapped column that are still valid
+        std::vector< column > matrix;      // columns that were written since loading
+
+        thread_local_storage< column > temp_column_buffer;
+
+    protected:
+        const index* _get_begin( index idx ) const {
+            return is_mapped[ idx ] ? (const index*)input->get_rows( idx ) : matrix[ idx ].data();
+        }
+
+        const index* _get_end( index idx ) const {
+            return _get_begin( idx ) + _get_size( idx );
+        }
+
+        index _get_size( index idx ) const {
+            return is_mapped[ idx ] ? mapped_sizes[ idx ] : (index)matrix[ idx ].size();
+        }
+
+    public:
+        // replaces the whole matrix by the columns of the mapped file
+        void _attach( const std::shared_ptr< const mapped_binary_matrix >& mapped_input ) {
+            input = mapped_input;
+            const index nr_of_columns = input->get_num_cols();
+            dims.resize( nr_of_columns );
+            is_mapped.assign( nr_of_columns, true );
+            mapped_sizes.resize( nr_of_columns );
+            std::vector< column >( nr_of_columns ).swap( matrix );
+            #pragma omp parallel for
+            for( index idx = 0; idx < nr_of_columns; idx++ ) {
+                dims[ idx ] = input->get_dim( idx );
+                mapped_sizes[ idx ] = input->get_num_rows( idx );
+            }
+        }
+
+        // overall number of cells in boundary_matrix
+        index _get_num_cols() const {
+            return (index)matrix.size();
+        }
+        void _set_num_cols( index nr_of_columns ) {
+            dims.resize( nr_of_columns );
+            is_mapped.resize( nr_of_columns, false );
+            mapped_sizes.resize( nr_of_columns, 0 );
+            matrix.resize( nr_of_columns );
+        }
+
+        // dimension of given index
+        dimension _get_dim( index idx ) const {
+            return dims[ idx ];
+        }
+        void _set_dim( index idx, dimension dim ) {
+            dims[ idx ] = dim;
+        }
+
+        // replaces(!) content of 'col' with boundary of given index
+        void _get_col( index idx, column& col ) const {
+            col.assign( _get_begin( idx ), _get_end( idx ) );
+        }
+        void _set_col( index idx, const column& col ) {
+            is_mapped[ idx ] = false;
+            matrix[ idx ] = col;
+        }
+
+        // true iff boundary of given idx is empty
+        bool _is_empty( index idx ) const {
+            return _get_size( idx ) == 0;
+        }
+
+        // largest row index of given column idx (new name for lowestOne())
+        index _get_max_index( index idx ) const {
+            return _is_empty( idx ) ? -1 : *( _get_end( idx ) - 1 );
+        }
+
+        // removes the maximal index of a column -- a mapped column just gets shorter
+        void _remove_max( index idx ) {
+            if( is_mapped[ idx ] )
+                mapped_sizes[ idx ]--;
+            else
+                matrix[ idx ].pop_back();
+        }
+
+        // clears given column
+        void _clear( index idx ) {
+            is_mapped[ idx ] = false;
+            matrix[ idx ].clear();
+        }
+
+        // syncronizes all data structures (essential for openmp stuff)
+        void _sync() {}
+
+        // adds column 'source' to column 'target' -- the result is always stored in 'matrix'
+        void _add_to( index source, index target ) {
+            column& temp_col = temp_column_buffer();
+            temp_col.resize( _get_size( source ) + _get_size( target ) );
+            index* col_end = symmetric_difference( _get_begin( target ), _get_end( target ),
+                                                   _get_begin( source ), _get_end( source ),
+                                                   temp_col.data() );
+            temp_col.erase( temp_col.begin() + ( col_end - temp_col.data() ), temp_col.end() );
+            matrix[ target ].swap( temp_col );
+            is_mapped[ target ] = false;
+        }
+
+        // finalizes given column
+        void _finalize( index idx ) {
+            column& col = matrix[ idx ];
+            column( col.begin(), col.end() ).swap( col );
+        }
+    };
+
+    // attaches the representation to the file instead of copying it
+    inline void load_mapped_binary( memory_mapped_column& rep, const std::shared_ptr< const mapped_binary_matrix >& input ) {
+        rep._attach( input );
+    }
+}
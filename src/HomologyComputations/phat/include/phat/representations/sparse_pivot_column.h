@@ -38,7 +38,8 @@ namespace phat {
             data.clear(); 
         }
 
-        void add_col( const column& col ) {
+        template< typename Column >
+        void add_col( const Column& col ) {
             for( index idx = 0; idx < (index) col.size(); idx++ )
                 add_index( col[ idx ] );
         }
@@ -47,7 +48,8 @@ namespace phat {
             return data.empty() ? -1 : *data.rbegin();
         }
 
-        void get_col_and_clear( column& col ) {
+        template< typename Column >
+        void get_col_and_clear( Column& col ) {
             col.assign( data.begin(), data.end() );
             data.clear();
         }
@@ -76,4 +78,5 @@ namespace phat {
     };
 
     typedef abstract_pivot_column< sparse_column > sparse_pivot_column;
+    typedef abstract_pivot_column< sparse_column, int32_t > sparse_pivot_column_32;
 }
@@ -21,25 +21,31 @@ along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
 #include "../helpers/misc.h"
 
 namespace phat {
-    class vector_heap {
+    template< typename IndexType = index >
+    class basic_vector_heap {
+
+    public:
+        typedef IndexType index_type;
 
     protected:
+        typedef std::vector< index_type > stored_column;
+
         std::vector< dimension > dims;
-        std::vector< column > matrix;
+        std::vector< stored_column > matrix;
 
         std::vector< index > inserts_since_last_prune;
 
-        mutable thread_local_storage< column > temp_column_buffer;
+        mutable thread_local_storage< stored_column > temp_column_buffer;
 
     protected:
         void _prune( index idx )
         {
-            column& col = matrix[ idx ];
-            column& temp_col = temp_column_buffer();
+            stored_column& col = matrix[ idx ];
+            stored_column& temp_col = temp_column_buffer();
             temp_col.clear();
             index max_index = _pop_max_index( col );
             while( max_index != -1 ) {
-                temp_col.push_back( max_index );
+                temp_col.push_back( (index_type)max_index );
                 max_index = _pop_max_index( col );
             }
             col = temp_col;
@@ -53,12 +59,12 @@ namespace phat {
             return _pop_max_index( matrix[ idx ] );
         }
 
-        index _pop_max_index( column& col ) const
+        index _pop_max_index( stored_column& col ) const
         {
             if( col.empty( ) )
                 return -1;
             else {
-                index max_element = col.front( );
+                index_type max_element = col.front( );
                 std::pop_heap( col.begin( ), col.end( ) );
                 col.pop_back( );
                 while( !col.empty( ) && col.front( ) == max_element ) {
@@ -113,7 +119,7 @@ namespace phat {
         }
         void _set_col( index idx, const column& col )
         {
-            matrix[ idx ] = col;
+            matrix[ idx ].assign( col.begin(), col.end() );
             std::make_heap( matrix[ idx ].begin( ), matrix[ idx ].end( ) );
         }
 
@@ -126,9 +132,9 @@ namespace phat {
         // largest row index of given column idx (new name for lowestOne())
         index _get_max_index( index idx ) const
         {
-            column& col = const_cast< column& >( matrix[ idx ] );
+            stored_column& col = const_cast< stored_column& >( matrix[ idx ] );
             index max_element = _pop_max_index( col );
-            col.push_back( max_element );
+            col.push_back( (index_type)max_element );
             std::push_heap( col.begin( ), col.end( ) );
             return max_element;
         }
@@ -167,4 +173,7 @@ namespace phat {
         }
 
     };
+
+    typedef basic_vector_heap< index > vector_heap;
+    typedef basic_vector_heap< int32_t > vector_heap_32;
 }
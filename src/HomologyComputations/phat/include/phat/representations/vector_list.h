@@ -21,11 +21,17 @@
 #include "../helpers/misc.h"
 
 namespace phat {
-    class vector_list {
+    template< typename IndexType = index >
+    class basic_vector_list {
+
+    public:
+        typedef IndexType index_type;
 
     protected:
+        typedef std::list< index_type > stored_column;
+
         std::vector< dimension > dims;
-        std::vector< std::list< index > > matrix;
+        std::vector< stored_column > matrix;
 
     public:
         // overall number of cells in boundary_matrix
@@ -70,7 +76,7 @@ namespace phat {
 
         // removes the maximal index of a column
         void _remove_max( index idx ) {
-            std::list< index >::iterator it = matrix[ idx ].end();
+            typename stored_column::iterator it = matrix[ idx ].end();
             it--;
             matrix[ idx ].erase( it );
         }
@@ -85,9 +91,9 @@ namespace phat {
 
         // adds column 'source' to column 'target'
         void _add_to( index source, index target ) {
-            std::list< index >& source_col = matrix[ source ];
-            std::list< index >& target_col = matrix[ target ];
-            std::list< index > temp_col;
+            stored_column& source_col = matrix[ source ];
+            stored_column& target_col = matrix[ target ];
+            stored_column temp_col;
             target_col.swap( temp_col );
             std::set_symmetric_difference( temp_col.begin(), temp_col.end(),
                                            source_col.begin(), source_col.end(),
@@ -98,4 +104,7 @@ namespace phat {
         void _finalize( index idx ) {
         }
     };
+
+    typedef basic_vector_list< index > vector_list;
+    typedef basic_vector_list< int32_t > vector_list_32;
 }
@@ -21,11 +21,17 @@
 #include "../helpers/misc.h"
 
 namespace phat {
-    class vector_set {
+    template< typename IndexType = index >
+    class basic_vector_set {
+
+    public:
+        typedef IndexType index_type;
 
     protected:
+        typedef std::set< index_type > stored_column;
+
         std::vector< dimension > dims;
-        std::vector< std::set< index > > matrix;
+        std::vector< stored_column > matrix;
 
     public:
         // overall number of cells in boundary_matrix
@@ -68,7 +74,7 @@ namespace phat {
 
         // removes the maximal index of a column
         void _remove_max( index idx ) {
-            std::set< index >::iterator it = matrix[ idx ].end();
+            typename stored_column::iterator it = matrix[ idx ].end();
             it--;
             matrix[ idx ].erase( it );
         }
@@ -83,9 +89,9 @@ namespace phat {
 
         // adds column 'source' to column 'target'
         void _add_to( index source, index target ) {
-            for( std::set< index >::iterator it = matrix[ source ].begin(); it != matrix[ source ].end(); it++ ) {
-				std::set< index >& col = matrix[ target ];
-				std::pair< std::set< index >::iterator, bool > result = col.insert( *it );
+            for( typename stored_column::iterator it = matrix[ source ].begin(); it != matrix[ source ].end(); it++ ) {
+				stored_column& col = matrix[ target ];
+				std::pair< typename stored_column::iterator, bool > result = col.insert( *it );
 				if( !result.second ) 
 					col.erase( result.first );
 			}
@@ -96,4 +102,7 @@ namespace phat {
         }
 
     };
+
+    typedef basic_vector_set< index > vector_set;
+    typedef basic_vector_set< int32_t > vector_set_32;
 }
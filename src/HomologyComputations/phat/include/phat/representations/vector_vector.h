@@ -19,15 +19,24 @@
 #pragma once
 
 #include "../helpers/misc.h"
+#include "../helpers/symmetric_difference.h"
 
 namespace phat {
-    class vector_vector {
+    // @IndexType is the integer type used to store the row indices of each column; columns are
+    // still passed in and out as 'column' (i.e., with 'index' entries).
+    template< typename IndexType = index >
+    class basic_vector_vector {
+
+    public:
+        typedef IndexType index_type;
 
     protected:
+        typedef std::vector< index_type > stored_column;
+
         std::vector< dimension > dims;
-        std::vector< column > matrix;
+        std::vector< stored_column > matrix;
 
-        thread_local_storage< column > temp_column_buffer;
+        thread_local_storage< stored_column > temp_column_buffer;
 
     public:
         // overall number of cells in boundary_matrix
@@ -49,10 +58,10 @@ namespace phat {
 
         // replaces(!) content of 'col' with boundary of given index
         void _get_col( index idx, column& col  ) const { 
-            col = matrix[ idx ]; 
+            col.assign( matrix[ idx ].begin(), matrix[ idx ].end() ); 
         }
         void _set_col( index idx, const column& col  ) { 
-            matrix[ idx ] = col; 
+            matrix[ idx ].assign( col.begin(), col.end() ); 
         }
 
         // true iff boundary of given idx is empty
@@ -62,7 +71,7 @@ namespace phat {
 
         // largest row index of given column idx (new name for lowestOne())
         index _get_max_index( index idx ) const { 
-            return matrix[ idx ].empty() ? -1 : matrix[ idx ].back(); 
+            return matrix[ idx ].empty() ? -1 : (index)matrix[ idx ].back(); 
         }
 
         // removes the maximal index of a column
@@ -80,19 +89,19 @@ namespace phat {
 
         // adds column 'source' to column 'target'
         void _add_to( index source, index target ) {
-            column& source_col = matrix[ source ];
-            column& target_col = matrix[ target ];
-            column& temp_col = temp_column_buffer();
+            stored_column& source_col = matrix[ source ];
+            stored_column& target_col = matrix[ target ];
+            stored_column& temp_col = temp_column_buffer();
             
             
             size_t new_size = source_col.size() + target_col.size();
             
             if (new_size > temp_col.size()) temp_col.resize(new_size);
             
-            std::vector<index>::iterator col_end = std::set_symmetric_difference( target_col.begin(), target_col.end(),
-                                           source_col.begin(), source_col.end(),
-                                                                                 temp_col.begin() );
-            temp_col.erase(col_end, temp_col.end());
+            index_type* col_end = symmetric_difference( target_col.data(), target_col.data() + target_col.size(),
+                                                        source_col.data(), source_col.data() + source_col.size(),
+                                                        temp_col.data() );
+            temp_col.erase(temp_col.begin() + (col_end - temp_col.data()), temp_col.end());
 
             
             target_col.swap(temp_col);
@@ -100,8 +109,11 @@ namespace phat {
         
         // finalizes given column
         void _finalize( index idx ) {
-            column& col = matrix[ idx ];
-            column(col.begin(), col.end()).swap(col);
+            stored_column& col = matrix[ idx ];
+            stored_column(col.begin(), col.end()).swap(col);
         }
     };
+
+    typedef basic_vector_vector< index > vector_vector;
+    typedef basic_vector_vector< int32_t > vector_vector_32;
 }
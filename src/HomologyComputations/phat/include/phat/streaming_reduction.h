@@ -0,0 +1,111 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "persistence_pairs.h"
+#include "helpers/misc.h"
+#include "helpers/symmetric_difference.h"
+#include "helpers/spilled_column_store.h"
+#include "helpers/column_reader.h"
+
+namespace phat {
+
+    // Column sink that computes persistence pairs while the boundary matrix is still arriving.
+    // Columns have to be pushed in filtration order; each one is reduced right away by the standard algorithm,
+    // which only ever adds columns to the left. Only reduced columns that own a pivot are kept -- in a
+    // spilled_column_store, so with a memory budget and a spill file the matrix does not have to fit into memory.
+    class streaming_reduction {
+
+    protected:
+        spilled_column_store reduced_columns;
+        std::vector< index > lowest_one_lookup;
+        persistence_pairs pairs;
+        index nr_columns;
+
+        column cur_col;
+        column temp_col;
+        column spill_buffer;
+
+    public:
+        // see spilled_column_store for the meaning of the arguments
+        streaming_reduction( index memory_budget = -1, const std::string& spill_filename = "" )
+            : reduced_columns( memory_budget, spill_filename ), nr_columns( 0 ) {}
+
+        // number of columns pushed so far
+        index get_num_cols() const { return nr_columns; }
+
+        // persistence pairs of all columns pushed so far -- unpaired columns are not listed, as in compute_persistence_pairs
+        const persistence_pairs& get_persistence_pairs() const { return pairs; }
+
+        const spilled_column_store& get_column_store() const { return reduced_columns; }
+
+        // Reduces 'col' as the next column of the filtration; its dimension is not needed by the standard algorithm.
+        // Returns false if a row of 'col' is not one of the columns pushed before it, or if the spill file could
+        // not be written or read (see spilled_column_store).
+        bool push_column( dimension /*dim*/, const column& col ) {
+            const index cur_idx = nr_columns++;
+            if( (index)lowest_one_lookup.size() < nr_columns )
+                lowest_one_lookup.resize( std::max( nr_columns, 2 * (index)lowest_one_lookup.size() ), -1 );
+
+            cur_col.assign( col.begin(), col.end() );
+            while( !cur_col.empty() ) {
+                const index lowest_one = cur_col.back();
+                if( lowest_one < 0 || lowest_one >= cur_idx )
+                    return false;
+                if( lowest_one_lookup[ lowest_one ] == -1 ) {
+                    lowest_one_lookup[ lowest_one ] = cur_idx;
+                    pairs.append_pair( lowest_one, cur_idx );
+                    return reduced_columns.set_col( cur_idx, cur_col );
+                }
+                const column* pivot_col = reduced_columns.get_col( lowest_one_lookup[ lowest_one ], spill_buffer );
+                if( pivot_col == 0 )
+                    return false;
+                temp_col.resize( cur_col.size() + pivot_col->size() );
+                index* col_end = symmetric_difference( cur_col.data(), cur_col.data() + cur_col.size(),
+                                                       pivot_col->data(), pivot_col->data() + pivot_col->size(),
+                                                       temp_col.data() );
+                temp_col.resize( col_end - temp_col.data() );
+                cur_col.swap( temp_col );
+            }
+            return true;
+        }
+
+        // Pushes all columns delivered by 'reader' (see helpers/column_reader.h). The next batch of columns is
+        // read while the current one is being reduced. Returns false if the reader reports a malformed file or
+        // push_column fails.
+        template< typename ColumnReader >
+        bool push_columns( ColumnReader& reader, index batch_size = 1 << 16 ) {
+            std::vector< dimension > cur_dims, next_dims;
+            std::vector< column > cur_cols, next_cols;
+            bool is_valid = reader.read_columns( batch_size, cur_dims, cur_cols );
+            bool is_pushed = true;
+            while( is_valid && is_pushed && !cur_cols.empty() ) {
+                #pragma omp parallel sections num_threads( 2 )
+                {
+                    #pragma omp section
+                    is_valid = reader.read_columns( batch_size, next_dims, next_cols );
+
+                    #pragma omp section
+                    for( index idx = 0; is_pushed && idx < (index)cur_cols.size(); idx++ )
+                        is_pushed = push_column( cur_dims[ idx ], cur_cols[ idx ] );
+                }
+                cur_dims.swap( next_dims );
+                cur_cols.swap( next_cols );
+            }
+            return is_valid && is_pushed;
+        }
+    };
+}
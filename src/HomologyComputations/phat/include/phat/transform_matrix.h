@@ -0,0 +1,126 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "helpers/misc.h"
+#include "helpers/symmetric_difference.h"
+#include "boundary_matrix.h"
+
+// Policies for the reduction algorithms that support it (standard_reduction and twist_reduction): they are told
+// about every column operation, so that the matrix V with R = D V can be recorded along the reduction.
+//     void init( index nr_columns )
+//     void add_to( index source, index target )   -- called along with boundary_matrix.add_to
+//     void finalize( index idx )                  -- column 'idx' of R is reduced
+//     void clear( index idx, const boundary_matrix< Representation >& reduced_matrix, index death )
+//                                                 -- column 'idx' was cleared, as it is the lowest one of 'death'
+namespace phat {
+
+    // does not record anything -- this is what the reduction algorithms use by default
+    class untracked_transform {
+    public:
+        void init( index /*nr_columns*/ ) {}
+        void add_to( index /*source*/, index /*target*/ ) {}
+        void finalize( index /*idx*/ ) {}
+        template< typename Representation >
+        void clear( index /*idx*/, const boundary_matrix< Representation >& /*reduced_matrix*/, index /*death*/ ) {}
+    };
+
+    // Records V. Columns of V are stored one after another in a single array once they are final; columns that
+    // were never modified are the identity column and are not stored at all. A cleared column 'idx' gets the
+    // reduced column of its death, which is a cycle with lowest one 'idx', so that R = D V holds for it as well.
+    class transform_matrix {
+
+    protected:
+        std::vector< index > col_begin;     // position of each column in 'entries', -1 for an identity column
+        std::vector< index > col_size;
+        std::vector< index > entries;
+
+        index working_col_idx;              // the column that is currently being reduced, -1 if none
+        column working_col;
+        column temp_col;
+
+        void store_col( index idx, const column& col ) {
+            col_begin[ idx ] = (index)entries.size();
+            col_size[ idx ] = (index)col.size();
+            entries.insert( entries.end(), col.begin(), col.end() );
+        }
+
+    public:
+        transform_matrix() : working_col_idx( -1 ) {}
+
+        index get_num_cols() const { return (index)col_begin.size(); }
+
+        // number of stored entries, i.e. without the identity columns
+        index get_num_entries() const { return (index)entries.size(); }
+
+        // replaces(!) content of 'col' with column 'idx' of V
+        void get_col( index idx, column& col ) const {
+            if( col_begin[ idx ] == -1 )
+                col.assign( 1, idx );
+            else
+                col.assign( entries.begin() + col_begin[ idx ], entries.begin() + col_begin[ idx ] + col_size[ idx ] );
+        }
+
+        void init( index nr_columns ) {
+            col_begin.assign( nr_columns, -1 );
+            col_size.assign( nr_columns, 1 );
+            entries.clear();
+            working_col_idx = -1;
+        }
+
+        void add_to( index source, index target ) {
+            if( working_col_idx != target ) {
+                working_col_idx = target;
+                working_col.assign( 1, target );
+            }
+            const index* source_begin = &source;
+            const index* source_end = source_begin + 1;
+            if( col_begin[ source ] != -1 ) {
+                source_begin = entries.data() + col_begin[ source ];
+                source_end = source_begin + col_size[ source ];
+            }
+            temp_col.resize( working_col.size() + ( source_end - source_begin ) );
+            index* col_end = symmetric_difference( working_col.data(), working_col.data() + working_col.size(),
+                                                   source_begin, source_end, temp_col.data() );
+            temp_col.resize( col_end - temp_col.data() );
+            working_col.swap( temp_col );
+        }
+
+        void finalize( index idx ) {
+            if( working_col_idx == idx ) {
+                store_col( idx, working_col );
+                working_col_idx = -1;
+            }
+        }
+
+        template< typename Representation >
+        void clear( index idx, const boundary_matrix< Representation >& reduced_matrix, index death ) {
+            reduced_matrix.get_col( death, temp_col );
+            store_col( idx, temp_col );
+        }
+    };
+
+    // A representative cycle of the class born at 'birth' after the reduction: the reduced column of its death,
+    // or, for an essential class (death == -1), column 'birth' of V.
+    template< typename Representation >
+    void get_representative_cycle( const boundary_matrix< Representation >& reduced_matrix, const transform_matrix& transform,
+                                   index birth, index death, column& cycle ) {
+        if( death != -1 )
+            reduced_matrix.get_col( death, cycle );
+        else
+            transform.get_col( birth, cycle );
+    }
+}
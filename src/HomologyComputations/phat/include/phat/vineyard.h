@@ -0,0 +1,178 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+#pragma once
+
+#include "persistence_pairs.h"
+#include "boundary_matrix.h"
+#include "helpers/misc.h"
+#include "helpers/symmetric_difference.h"
+
+namespace phat {
+
+    // Persistence of a filtration that changes by transpositions of adjacent cells, as in "Vines and Vineyards by
+    // Updating Persistence in Linear Time" (Cohen-Steiner, Edelsbrunner, Morozov). The decomposition R = D V of the
+    // boundary matrix D is kept with R reduced and V upper triangular, so a transposition only touches the two
+    // swapped columns, rows and the columns paired with them. Instead of the case distinction of the paper, the
+    // update makes V upper triangular again and then resolves the lowest ones that collide by adding the earlier
+    // column to the later one; this covers all cases and needs at most a few column additions.
+    class vineyard {
+
+    protected:
+        std::vector< column > reduced_cols;     // R
+        std::vector< column > transform_cols;   // V
+        std::vector< dimension > dims;
+        std::vector< index > lowest_one_lookup; // column of R with the given lowest one, -1 otherwise
+
+        column temp_col;
+        std::vector< index > worklist;
+
+        static index get_max_index( const column& col ) { return col.empty() ? -1 : col.back(); }
+
+        static bool contains( const column& col, index row ) { return std::binary_search( col.begin(), col.end(), row ); }
+
+        void add_col( const column& source, column& target ) {
+            temp_col.resize( source.size() + target.size() );
+            index* col_end = symmetric_difference( target.data(), target.data() + target.size(),
+                                                   source.data(), source.data() + source.size(), temp_col.data() );
+            temp_col.resize( col_end - temp_col.data() );
+            target.swap( temp_col );
+        }
+
+        // R_target += R_source and V_target += V_source, for source < target
+        void add_to( index source, index target ) {
+            add_col( reduced_cols[ source ], reduced_cols[ target ] );
+            add_col( transform_cols[ source ], transform_cols[ target ] );
+        }
+
+        // exchanges the rows 'row' and 'row' + 1 -- as they are adjacent, the column stays sorted
+        static void swap_rows( column& col, index row ) {
+            column::iterator it = std::lower_bound( col.begin(), col.end(), row );
+            if( it == col.end() || *it > row + 1 )
+                return;
+            if( *it == row ) {
+                if( it + 1 == col.end() || *( it + 1 ) != row + 1 )
+                    *it = row + 1;
+            } else {
+                *it = row;
+            }
+        }
+
+        // reduces the columns on the worklist until all lowest ones are unique again
+        void resolve_collisions() {
+            while( !worklist.empty() ) {
+                const index cur_col = worklist.back();
+                worklist.pop_back();
+                index lowest_one = get_max_index( reduced_cols[ cur_col ] );
+                while( lowest_one != -1 ) {
+                    const index owner = lowest_one_lookup[ lowest_one ];
+                    if( owner == -1 || owner == cur_col ) {
+                        lowest_one_lookup[ lowest_one ] = cur_col;
+                        break;
+                    }
+                    if( owner < cur_col ) {
+                        add_to( owner, cur_col );
+                        lowest_one = get_max_index( reduced_cols[ cur_col ] );
+                    } else {
+                        add_to( cur_col, owner );
+                        lowest_one_lookup[ lowest_one ] = cur_col;
+                        worklist.push_back( owner );
+                        break;
+                    }
+                }
+            }
+        }
+
+    public:
+        // copies 'boundary_matrix' and reduces it by the standard algorithm, starting from V = identity
+        template< typename Representation >
+        void init( const boundary_matrix< Representation >& boundary_matrix ) {
+            const index nr_columns = boundary_matrix.get_num_cols();
+            reduced_cols.resize( nr_columns );
+            transform_cols.resize( nr_columns );
+            dims.resize( nr_columns );
+            lowest_one_lookup.assign( nr_columns, -1 );
+            for( index cur_col = 0; cur_col < nr_columns; cur_col++ ) {
+                boundary_matrix.get_col( cur_col, reduced_cols[ cur_col ] );
+                transform_cols[ cur_col ].assign( 1, cur_col );
+                dims[ cur_col ] = boundary_matrix.get_dim( cur_col );
+                worklist.push_back( cur_col );
+                resolve_collisions();
+            }
+        }
+
+        index get_num_cols() const { return (index)reduced_cols.size(); }
+
+        dimension get_dim( index idx ) const { return dims[ idx ]; }
+
+        // column 'idx' of R and V
+        const column& get_reduced_col( index idx ) const { return reduced_cols[ idx ]; }
+        const column& get_transform_col( index idx ) const { return transform_cols[ idx ]; }
+
+        // the cell that 'idx' is paired with, -1 for an essential cell
+        index get_partner( index idx ) const {
+            return reduced_cols[ idx ].empty() ? lowest_one_lookup[ idx ] : reduced_cols[ idx ].back();
+        }
+
+        // pairs of the current filtration, by increasing death
+        void get_persistence_pairs( persistence_pairs& pairs ) const {
+            pairs.clear();
+            for( index idx = 0; idx < get_num_cols(); idx++ )
+                if( !reduced_cols[ idx ].empty() )
+                    pairs.append_pair( reduced_cols[ idx ].back(), idx );
+        }
+
+        // Swaps the cells at positions 'pos' and 'pos' + 1 of the filtration, which must stay a filtration, i.e.,
+        // cell 'pos' must not be a face of cell 'pos' + 1 (this is not checked). Returns true iff the two cells
+        // exchanged their partners -- the only way a transposition can change the pairing. Exchanging the rows
+        // visits every column once, everything else only touches a few columns.
+        bool transpose( index pos ) {
+            const index next = pos + 1;
+            const index old_partner_of_pos = get_partner( pos );
+
+            // the columns whose lowest one may change: the swapped ones and the ones paired with them
+            index affected[ 4 ] = { pos, next, lowest_one_lookup[ pos ], lowest_one_lookup[ next ] };
+            for( int idx = 0; idx < 4; idx++ )
+                if( affected[ idx ] != -1 && !reduced_cols[ affected[ idx ] ].empty() )
+                    lowest_one_lookup[ reduced_cols[ affected[ idx ] ].back() ] = -1;
+
+            // keeps V upper triangular after the swap
+            if( contains( transform_cols[ next ], pos ) )
+                add_to( pos, next );
+
+            reduced_cols[ pos ].swap( reduced_cols[ next ] );
+            transform_cols[ pos ].swap( transform_cols[ next ] );
+            std::swap( dims[ pos ], dims[ next ] );
+            for( index idx = pos; idx < get_num_cols(); idx++ ) {
+                swap_rows( reduced_cols[ idx ], pos );
+                swap_rows( transform_cols[ idx ], pos );
+            }
+
+            for( int idx = 0; idx < 4; idx++ ) {
+                if( affected[ idx ] == pos || affected[ idx ] == next )
+                    affected[ idx ] = pos + next - affected[ idx ];
+                if( affected[ idx ] != -1 )
+                    worklist.push_back( affected[ idx ] );
+            }
+            resolve_collisions();
+
+            // the cell that was at 'pos' is now at 'next'
+            index old_partner = old_partner_of_pos;
+            if( old_partner == pos || old_partner == next )
+                old_partner = pos + next - old_partner;
+            return get_partner( next ) != old_partner;
+        }
+    };
+}
@@ -0,0 +1,151 @@
+/*  This file is part of PHAT.
+
+    PHAT is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    PHAT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
+
+// Microbenchmark for the column addition kernel: records the operands of the column additions that
+// the twist algorithm performs on the given inputs and replays them with std::set_symmetric_difference
+// and with phat::symmetric_difference.
+
+#include "../include/phat/compute_persistence_pairs.h"
+
+#include "../include/phat/representations/vector_vector.h"
+#include "../include/phat/algorithms/twist_reduction.h"
+#include "../include/phat/helpers/symmetric_difference.h"
+
+// pairs of (target, source) columns as they were seen by _add_to
+std::vector< std::pair< phat::column, phat::column > > recorded_additions;
+phat::index max_recorded_entries = 1 << 24;
+phat::index recorded_entries = 0;
+
+class recording_vector_vector : public phat::vector_vector {
+public:
+    void _add_to( phat::index source, phat::index target ) {
+        if( recorded_entries < max_recorded_entries ) {
+            recorded_additions.push_back( std::make_pair( matrix[ target ], matrix[ source ] ) );
+            recorded_entries += matrix[ target ].size() + matrix[ source ].size();
+        }
+        phat::vector_vector::_add_to( source, target );
+    }
+};
+
+void print_help() {
+    std::cerr << "Usage: " << "add_to_benchmark " << "[options] input_filename_0 input_filename_1 ... input_filename_N" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "--ascii   --  use ascii file format" << std::endl;
+    std::cerr << "--binary  --  use binary file format (default)" << std::endl;
+    std::cerr << "--help    --  prints this screen" << std::endl;
+}
+
+void print_help_and_exit() {
+    print_help();
+    exit( EXIT_FAILURE );
+}
+
+void parse_command_line( int argc, char** argv, bool& use_binary, std::vector< std::string >& input_filenames ) {
+
+    if( argc < 2 ) print_help_and_exit();
+
+    for( int idx = 1; idx < argc; idx++ ) {
+        const std::string argument = argv[ idx ];
+        if( argument.size() > 2 && argument[ 0 ] == '-' && argument[ 1 ] == '-' ) {
+            if( argument == "--ascii" ) use_binary = false;
+            else if( argument == "--binary" ) use_binary = true;
+            else if( argument == "--help" ) print_help_and_exit();
+            else print_help_and_exit();
+        } else {
+            input_filenames.push_back( argument );
+        }
+    }
+}
+
+// replays all recorded additions 'repetitions' times with the given kernel and returns the nanoseconds per input entry
+template< typename T, typename Kernel >
+double time_kernel( const std::vector< std::pair< std::vector< T >, std::vector< T > > >& additions, Kernel kernel, phat::index repetitions, phat::index& checksum ) {
+    std::vector< T > result;
+    double timer = omp_get_wtime();
+    for( phat::index rep = 0; rep < repetitions; rep++ ) {
+        for( std::size_t idx = 0; idx < additions.size(); idx++ ) {
+            const std::vector< T >& a = additions[ idx ].first;
+            const std::vector< T >& b = additions[ idx ].second;
+            if( result.size() < a.size() + b.size() )
+                result.resize( a.size() + b.size() );
+            checksum += kernel( a.data(), a.data() + a.size(), b.data(), b.data() + b.size(), result.data() ) - result.data();
+        }
+    }
+    return ( omp_get_wtime() - timer ) * 1e9 / (double)( repetitions * recorded_entries );
+}
+
+template< typename T >
+T* stl_kernel( const T* a, const T* a_end, const T* b, const T* b_end, T* out ) {
+    return std::set_symmetric_difference( a, a_end, b, b_end, out );
+}
+
+template< typename T >
+void compare_kernels( const std::string& type_name ) {
+    std::vector< std::pair< std::vector< T >, std::vector< T > > > additions( recorded_additions.size() );
+    for( std::size_t idx = 0; idx < recorded_additions.size(); idx++ ) {
+        additions[ idx ].first.assign( recorded_additions[ idx ].first.begin(), recorded_additions[ idx ].first.end() );
+        additions[ idx ].second.assign( recorded_additions[ idx ].second.begin(), recorded_additions[ idx ].second.end() );
+    }
+
+    // aim for roughly 1e8 processed entries per kernel
+    const phat::index repetitions = std::max( (phat::index)1, (phat::index)100000000 / std::max( recorded_entries, (phat::index)1 ) );
+
+    phat::index stl_checksum = 0;
+    phat::index scalar_checksum = 0;
+    phat::index phat_checksum = 0;
+    const double stl_time = time_kernel( additions, &stl_kernel< T >, repetitions, stl_checksum );
+    const double scalar_time = time_kernel( additions, &phat::symmetric_difference_scalar< T >, repetitions, scalar_checksum );
+    const double phat_time = time_kernel( additions, phat::symmetric_difference_kernel< T >::get(), repetitions, phat_checksum );
+
+    std::cout << "\t" << type_name << ": std::set_symmetric_difference " << std::setprecision( 3 ) << stl_time << " ns/entry"
+              << ", scalar kernel " << scalar_time << " ns/entry"
+              << ", dispatched kernel " << phat_time << " ns/entry"
+              << " (speedup " << stl_time / phat_time << "x)" << std::endl;
+
+    if( stl_checksum != scalar_checksum || stl_checksum != phat_checksum )
+        std::cerr << "Error: kernels disagree on the result sizes!" << std::endl;
+}
+
+int main( int argc, char** argv )
+{
+    bool use_binary = true; // interpret inputs as binary or ascii files
+    std::vector< std::string > input_filenames; // name of file that contains the boundary matrix
+
+    parse_command_line( argc, argv, use_binary, input_filenames );
+
+    const char* simd_names[] = { "none", "avx2", "avx512" };
+    std::cout << "SIMD support: " << simd_names[ phat::get_simd_level() ] << std::endl;
+
+    for( int idx_input = 0; idx_input < (int)input_filenames.size(); idx_input++ ) {
+        std::string input_filename = input_filenames[ idx_input ];
+        phat::boundary_matrix< recording_vector_vector > matrix;
+        bool read_successful = use_binary ? matrix.load_binary( input_filename ) : matrix.load_ascii( input_filename );
+        if( !read_successful ) {
+            std::cerr << std::endl << " Error opening file " << input_filename << std::endl;
+            print_help_and_exit();
+        }
+
+        recorded_additions.clear();
+        recorded_entries = 0;
+        phat::twist_reduction reduce;
+        reduce( matrix );
+
+        std::cout << input_filename << ": " << recorded_additions.size() << " column additions with " << recorded_entries << " entries" << std::endl;
+        compare_kernels< int64_t >( "int64" );
+        compare_kernels< int32_t >( "int32" );
+    }
+}
@@ -26,12 +26,16 @@
 #include "../include/phat/representations/heap_pivot_column.h"
 #include "../include/phat/representations/full_pivot_column.h"
 #include "../include/phat/representations/bit_tree_pivot_column.h"
+#include "../include/phat/representations/compressed_sparse_column.h"
+#include "../include/phat/representations/memory_mapped_column.h"
 
 #include "../include/phat/algorithms/twist_reduction.h"
 #include "../include/phat/algorithms/standard_reduction.h"
 #include "../include/phat/algorithms/row_reduction.h"
 #include "../include/phat/algorithms/chunk_reduction.h"
 #include "../include/phat/algorithms/spectral_sequence_reduction.h"
+#include "../include/phat/algorithms/parallel_twist_reduction.h"
+#include "../include/phat/algorithms/cohomology_reduction.h"
 
 #include "../include/phat/helpers/dualize.h"	
 
@@ -39,8 +43,8 @@
 #include <iomanip>
 
 
-enum Representation_type { VECTOR_VECTOR, VECTOR_HEAP, VECTOR_SET, SPARSE_PIVOT_COLUMN, HEAP_PIVOT_COLUMN, FULL_PIVOT_COLUMN, BIT_TREE_PIVOT_COLUMN, VECTOR_LIST };
-enum Algorithm_type  {STANDARD, TWIST, ROW, CHUNK, CHUNK_SEQUENTIAL, SPECTRAL_SEQUENCE};
+enum Representation_type { VECTOR_VECTOR, VECTOR_HEAP, VECTOR_SET, SPARSE_PIVOT_COLUMN, HEAP_PIVOT_COLUMN, FULL_PIVOT_COLUMN, BIT_TREE_PIVOT_COLUMN, VECTOR_LIST, COMPRESSED_SPARSE_COLUMN, MEMORY_MAPPED_COLUMN };
+enum Algorithm_type  {STANDARD, TWIST, ROW, CHUNK, CHUNK_SEQUENTIAL, SPECTRAL_SEQUENCE, PARALLEL_TWIST, COHOMOLOGY};
 enum Ansatz_type  {PRIMAL, DUAL};
 
 void print_help() {
@@ -54,8 +58,8 @@ void print_help() {
     std::cerr << "--help    --  prints this screen" << std::endl;
     std::cerr << "--dual   --  use only dualization approach" << std::endl;
     std::cerr << "--primal   --  use only primal approach" << std::endl;
-    std::cerr << "--vector_vector, --vector_heap, --vector_set, --vector_list, --full_pivot_column, --sparse_pivot_column, --heap_pivot_column, --bit_tree_pivot_column  --  use only a subset of representation data structures for boundary matrices" << std::endl;
-    std::cerr << "--standard, --twist, --chunk, --chunk_sequential, --spectral_sequence, --row  --  use only a subset of reduction algorithms" << std::endl;
+    std::cerr << "--vector_vector, --vector_heap, --vector_set, --vector_list, --full_pivot_column, --sparse_pivot_column, --heap_pivot_column, --bit_tree_pivot_column, --compressed_sparse_column, --memory_mapped_column  --  use only a subset of representation data structures for boundary matrices" << std::endl;
+    std::cerr << "--standard, --twist, --parallel_twist, --chunk, --chunk_sequential, --spectral_sequence, --row, --cohomology  --  use only a subset of reduction algorithms" << std::endl;
 }
 
 void print_help_and_exit() {
@@ -83,8 +87,12 @@ void parse_command_line( int argc, char** argv, bool& latex_tables_output, bool&
             else if( argument == "--bit_tree_pivot_column" )  representations.push_back( BIT_TREE_PIVOT_COLUMN );
             else if( argument == "--sparse_pivot_column" ) representations.push_back( SPARSE_PIVOT_COLUMN );
             else if( argument == "--heap_pivot_column" ) representations.push_back( HEAP_PIVOT_COLUMN );
+            else if( argument == "--compressed_sparse_column" ) representations.push_back( COMPRESSED_SPARSE_COLUMN );
+            else if( argument == "--memory_mapped_column" ) representations.push_back( MEMORY_MAPPED_COLUMN );
             else if( argument == "--standard" ) algorithms.push_back( STANDARD );
             else if( argument == "--twist" ) algorithms.push_back( TWIST );
+            else if( argument == "--parallel_twist" ) algorithms.push_back( PARALLEL_TWIST );
+            else if( argument == "--cohomology" ) algorithms.push_back( COHOMOLOGY );
             else if( argument == "--row" ) algorithms.push_back( ROW );
             else if( argument == "--chunk_sequential" ) algorithms.push_back( CHUNK_SEQUENTIAL );
             else if( argument == "--spectral_sequence" ) algorithms.push_back( SPECTRAL_SEQUENCE );
@@ -101,6 +109,8 @@ void parse_command_line( int argc, char** argv, bool& latex_tables_output, bool&
     if( representations.empty() == true ) {
         representations.push_back( VECTOR_LIST );
         representations.push_back( VECTOR_VECTOR );
+        representations.push_back( COMPRESSED_SPARSE_COLUMN );
+        representations.push_back( MEMORY_MAPPED_COLUMN );
         representations.push_back( VECTOR_SET );
         representations.push_back( VECTOR_HEAP );
         representations.push_back( HEAP_PIVOT_COLUMN );
@@ -114,6 +124,8 @@ void parse_command_line( int argc, char** argv, bool& latex_tables_output, bool&
         algorithms.push_back( TWIST );
         algorithms.push_back( ROW );
         algorithms.push_back( CHUNK );
+        algorithms.push_back( PARALLEL_TWIST );
+        algorithms.push_back( COHOMOLOGY );
         algorithms.push_back( SPECTRAL_SEQUENCE );
        // algorithms.push_back( CHUNK_SEQUENTIAL );
     }
@@ -193,6 +205,8 @@ void benchmark_latex( std::string input_filename, bool use_binary, Ansatz_type a
     switch( algorithm ) { \
     case STANDARD: std::cout << " standard,"; benchmark< phat::Representation, phat::standard_reduction >( input_filename, use_binary, ansatz ); break; \
     case TWIST: std::cout << " twist,"; benchmark< phat::Representation, phat::twist_reduction >( input_filename, use_binary, ansatz ); break; \
+    case PARALLEL_TWIST: std::cout << " parallel twist,"; benchmark< phat::Representation, phat::parallel_twist_reduction >( input_filename, use_binary, ansatz ); break; \
+    case COHOMOLOGY: std::cout << " cohomology,"; benchmark< phat::Representation, phat::cohomology_reduction >( input_filename, use_binary, ansatz ); break; \
     case ROW: std::cout << " row,"; benchmark< phat::Representation, phat::row_reduction >( input_filename, use_binary, ansatz ); break; \
     case CHUNK: std::cout << " chunk,"; benchmark< phat::Representation, phat::chunk_reduction >( input_filename, use_binary, ansatz ); break; \
     case SPECTRAL_SEQUENCE: std::cout << " spectral sequence,"; benchmark< phat::Representation, phat::spectral_sequence_reduction >( input_filename, use_binary, ansatz ); break; \
@@ -208,6 +222,8 @@ void benchmark_latex( std::string input_filename, bool use_binary, Ansatz_type a
     switch( algorithm ) { \
     case STANDARD: benchmark_latex< phat::Representation, phat::standard_reduction >( input_filename, use_binary, ansatz ); break; \
     case TWIST: benchmark_latex< phat::Representation, phat::twist_reduction >( input_filename, use_binary, ansatz ); break; \
+    case PARALLEL_TWIST: benchmark_latex< phat::Representation, phat::parallel_twist_reduction >( input_filename, use_binary, ansatz ); break; \
+    case COHOMOLOGY: benchmark_latex< phat::Representation, phat::cohomology_reduction >( input_filename, use_binary, ansatz ); break; \
     case ROW: benchmark_latex< phat::Representation, phat::row_reduction >( input_filename, use_binary, ansatz ); break; \
     case CHUNK: benchmark_latex< phat::Representation, phat::chunk_reduction >( input_filename, use_binary, ansatz ); break; \
     case SPECTRAL_SEQUENCE: benchmark_latex< phat::Representation, phat::spectral_sequence_reduction >( input_filename, use_binary, ansatz ); break; \
@@ -249,6 +265,8 @@ int main( int argc, char** argv )
                         case BIT_TREE_PIVOT_COLUMN: COMPUTE(bit_tree_pivot_column) break;
                         case SPARSE_PIVOT_COLUMN: COMPUTE(sparse_pivot_column) break;
                         case HEAP_PIVOT_COLUMN: COMPUTE(heap_pivot_column) break;
+                        case COMPRESSED_SPARSE_COLUMN: COMPUTE(compressed_sparse_column) break;
+                        case MEMORY_MAPPED_COLUMN: COMPUTE(memory_mapped_column) break;
                         }
                     }
                 }
@@ -278,6 +296,8 @@ int main( int argc, char** argv )
                 case BIT_TREE_PIVOT_COLUMN: std::cout << "P-Bit-Tree"; break;
                 case SPARSE_PIVOT_COLUMN: std::cout << "P-Set"; break;
                 case HEAP_PIVOT_COLUMN: std::cout << "P-Heap"; break;
+                case COMPRESSED_SPARSE_COLUMN: std::cout << "CSC"; break;
+                case MEMORY_MAPPED_COLUMN: std::cout << "Mapped"; break;
                 }
                 std::cout << std::setw( 1 );
             }
@@ -294,6 +314,8 @@ int main( int argc, char** argv )
                         switch( algorithm ) {
                         case STANDARD: std::cout << "standard"; break;
                         case TWIST: std::cout << "twist"; break;
+                        case PARALLEL_TWIST: std::cout << "parallel twist"; break;
+                        case COHOMOLOGY: std::cout << "cohomology"; break;
                         case ROW: std::cout << "row"; break;
                         case CHUNK: std::cout << "chunk"; break;
                         case SPECTRAL_SEQUENCE: std::cout << "spectral sequence"; break;
@@ -303,6 +325,8 @@ int main( int argc, char** argv )
                         switch( algorithm ) {
                         case STANDARD: std::cout << "standard$^*$"; break;
                         case TWIST: std::cout << "twist$^*$"; break;
+                        case PARALLEL_TWIST: std::cout << "parallel twist$^*$"; break;
+                        case COHOMOLOGY: std::cout << "cohomology$^*$"; break;
                         case ROW: std::cout << "row$^*$"; break;
                         case CHUNK: std::cout << "chunk$^*$"; break;
                         case SPECTRAL_SEQUENCE: std::cout << "spectral sequence$^*$"; break;
@@ -323,6 +347,8 @@ int main( int argc, char** argv )
                         case BIT_TREE_PIVOT_COLUMN: COMPUTE_LATEX( bit_tree_pivot_column ) break;
                         case SPARSE_PIVOT_COLUMN: COMPUTE_LATEX( sparse_pivot_column ) break;
                         case HEAP_PIVOT_COLUMN: COMPUTE_LATEX( heap_pivot_column ) break;
+                        case COMPRESSED_SPARSE_COLUMN: COMPUTE_LATEX( compressed_sparse_column ) break;
+                        case MEMORY_MAPPED_COLUMN: COMPUTE_LATEX( memory_mapped_column ) break;
                         }
                     }
                     std::cout << " \\\\" << std::endl;
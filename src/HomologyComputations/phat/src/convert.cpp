@@ -21,6 +21,8 @@
 #include "../include/phat/boundary_matrix.h"
 #include "../include/phat/helpers/dualize.h"
 
+enum File_format_type { BINARY, ASCII, COMPACT };
+
 void print_help() {
     std::cerr << "Usage: " << "convert " << "[options] input_filename output_filename" << std::endl;
     std::cerr << std::endl;
@@ -28,8 +30,10 @@ void print_help() {
     std::cerr << std::endl;
     std::cerr << "--ascii   --  use ascii file format for input_filename" << std::endl;
     std::cerr << "--binary  --  use binary file format for input_filename (default)" << std::endl;
+    std::cerr << "--compact --  use compact binary file format for input_filename" << std::endl;
     std::cerr << "--save-ascii   --  use ascii file format for output_filename" << std::endl;
     std::cerr << "--save-binary  --  use binary file format for output_filename (default)" << std::endl;
+    std::cerr << "--save-compact --  use compact binary file format for output_filename" << std::endl;
     std::cerr << "--dualize --  dualize filtration" << std::endl;
     std::cerr << "--help    --  prints this screen" << std::endl;
 }
@@ -39,7 +43,7 @@ void print_help_and_exit() {
     exit( EXIT_FAILURE );
 }
 
-void parse_command_line( int argc, char** argv, bool& use_binary, bool& use_save_binary, bool& use_dualize, std::string& input_filename, std::string& output_filename) {
+void parse_command_line( int argc, char** argv, File_format_type& file_format, File_format_type& save_file_format, bool& use_dualize, std::string& input_filename, std::string& output_filename) {
 
     if( argc < 3 ) print_help_and_exit();
 
@@ -50,10 +54,12 @@ void parse_command_line( int argc, char** argv, bool& use_binary, bool& use_save
         const std::string option = argv[ idx ];
 
         if( option == "--dualize" ) use_dualize = true;
-        else if( option == "--ascii" ) use_binary = false;
-        else if( option == "--binary" ) use_binary = true;
-        else if( option == "--save-ascii" ) use_save_binary = false;
-        else if( option == "--save-binary" ) use_save_binary = true;
+        else if( option == "--ascii" ) file_format = ASCII;
+        else if( option == "--binary" ) file_format = BINARY;
+        else if( option == "--compact" ) file_format = COMPACT;
+        else if( option == "--save-ascii" ) save_file_format = ASCII;
+        else if( option == "--save-binary" ) save_file_format = BINARY;
+        else if( option == "--save-compact" ) save_file_format = COMPACT;
         else if( option == "--help" ) print_help_and_exit();
         else print_help_and_exit();
     }
@@ -61,16 +67,18 @@ void parse_command_line( int argc, char** argv, bool& use_binary, bool& use_save
 
 int main( int argc, char** argv )
 {
-    bool use_binary = true; // interpret input as binary or ascii file
-    bool use_save_binary = true; // write output as binary or ascii file
+    File_format_type file_format = BINARY; // interpret input as binary, ascii or compact file
+    File_format_type save_file_format = BINARY; // write output as binary, ascii or compact file
     bool use_dualize = false; // dualize filtration
     std::string input_filename; // name of file that contains the boundary matrix
     std::string output_filename; // name of file that will contain the boundary matrix in the new binary format
 
-    parse_command_line( argc, argv, use_binary, use_save_binary, use_dualize, input_filename, output_filename );
+    parse_command_line( argc, argv, file_format, save_file_format, use_dualize, input_filename, output_filename );
     
     phat::boundary_matrix< phat::bit_tree_pivot_column > matrix;
-    if( use_binary )
+    if( file_format == COMPACT )
+        matrix.load_compact( input_filename );
+    else if( file_format == BINARY )
         matrix.load_binary( input_filename );
     else
         matrix.load_ascii( input_filename );
@@ -78,7 +86,9 @@ int main( int argc, char** argv )
     if( use_dualize )
         dualize( matrix );
 
-    if( use_save_binary )
+    if( save_file_format == COMPACT )
+        matrix.save_compact( output_filename );
+    else if( save_file_format == BINARY )
         matrix.save_binary( output_filename );
     else
         matrix.save_ascii( output_filename );
@@ -19,6 +19,7 @@
  
  
 #include "../include/phat/compute_persistence_pairs.h"
+#include "../include/phat/incremental_reduction.h"
 
 // main data structure (choice affects performance)
 #include "../include/phat/representations/vector_vector.h"
@@ -270,11 +271,169 @@ OutputIt compute_betti_numbers_not_optimal(const std::uint64_t number_of_cells,
 
 
 
+/**
+ * This is an auxiliary procedure that reads a single cell of the encoded 
+ * vector representing boundary matrix (see 
+ * reduce_boundary_matrix_with_phat_C_style_input), starting at 
+ * xbegin[position]. cell_number is the number of the cell, counted from 0.
+ * Its dimension is stored in dimension_ and its boundary in temp_col, 
+ * position is moved to the next cell.
+**/ 
+template <class RandomIt>
+void read_cell_from_C_style_input
+(RandomIt xbegin,
+std::size_t& position,
+const std::uint64_t cell_number,
+unsigned& dimension_,
+std::vector< phat::index >& temp_col )
+{
+	//each cell is encoded in a vector by the following string:
+	//cell id (to check if it is equal i+1)
+	//dimension
+	//and then the sequence of boundary elements
+	//-1 indicate the end of a cell.
+
+	//first we check if the cell id  is the right one:
+	size_t cell_id = (size_t)xbegin[position];
+	assert ( cell_number+1 == cell_id );
+	//without asserts the id and the number of the cell are not used.
+	(void)cell_id;
+	(void)cell_number;
+	++position;
+
+	//we read the dimension of a cell:
+	dimension_ = (unsigned)xbegin[position];	 
+	++position;
+
+	//and now we read the vector of boundary
+	temp_col.clear();
+	while ( xbegin[position] != -1 )
+	{
+	  //-1, since we convert from Julia to C++ style.		  
+	  temp_col.push_back( (unsigned)xbegin[position]-1 );
+	  ++position;
+	}	  
+
+	++position;	
+}
+
+
+
+
+/**
+ * This is an auxiliary procedure that reads the encoded vector representing 
+ * boundary matrix (see reduce_boundary_matrix_with_phat_C_style_input) into
+ * boundary_matrix. The dimensions of the cells are stored in dimensions, 
+ * temp_col is a buffer that can be reused between calls.
+**/ 
+template <class RandomIt, typename PHAT_collumn_representation>
+void load_boundary_matrix_from_C_style_input
+(phat::boundary_matrix<PHAT_collumn_representation >& boundary_matrix,
+const std::uint64_t number_of_cells,
+RandomIt xbegin,
+std::vector<unsigned>& dimensions,
+std::vector< phat::index >& temp_col )
+{
+	//set the number of columns (equal to the size of compute_persistence_from_sparse_matrix)
+	boundary_matrix.set_num_cols( number_of_cells );	 
+	dimensions.clear();
+	dimensions.reserve( number_of_cells );
+	 
+	std::size_t position = 0;				  
+	for (std::size_t i = 0; i < number_of_cells; i++) 
+	{
+		unsigned dimension_;
+		read_cell_from_C_style_input( xbegin, position, i, dimension_, temp_col );
+		dimensions.push_back( dimension_ );
+		boundary_matrix.set_dim( i, dimension_ );
+		boundary_matrix.set_col( i, temp_col );
+	}
+}
+
+
+
+
+/**
+ * This is an auxiliary procedure that loads a boundary matrix given in the 
+ * compressed sparse column format of Julia's SparseMatrixCSC: col_ptr has 
+ * number_of_cells + 1 entries and the boundary of the i-th cell (counting 
+ * from 1) consists of the cells row_idx[ col_ptr[i-1]-1 ], ..., 
+ * row_idx[ col_ptr[i]-2 ]. As in Julia, all the indices start from 1. 
+ * dims[i-1] is the dimension of the i-th cell. The cells are copied in 
+ * parallel, with 64 bit indices, straight into the compressed buffers that 
+ * the boundary matrix is loaded from. A boundary that is not sorted is 
+ * sorted there.
+**/ 
+template <typename PHAT_collumn_representation>
+void load_boundary_matrix_from_CSR_input
+(phat::boundary_matrix<PHAT_collumn_representation >& boundary_matrix,
+const std::uint64_t number_of_cells,
+const std::int64_t* col_ptr,
+const std::int64_t* row_idx,
+const std::int64_t* dims)
+{
+	const std::int64_t n = (std::int64_t)number_of_cells;
+	std::vector< phat::dimension > cell_dims( n );
+	std::vector< phat::index > offsets( n + 1 );
+	std::vector< phat::index > entries( col_ptr[n] - col_ptr[0] );
+
+	#pragma omp parallel for
+	for ( std::int64_t i = 0 ; i < n ; ++i )
+	{
+		cell_dims[i] = (phat::dimension)dims[i];
+		offsets[i] = col_ptr[i] - col_ptr[0];
+		phat::index* col_begin = entries.data() + offsets[i];
+		phat::index* col_end = col_begin + ( col_ptr[i+1] - col_ptr[i] );
+		//-1, since we convert from Julia to C++ style.
+		const std::int64_t* rows = row_idx + col_ptr[i] - 1;
+		bool is_sorted = true;
+		for ( phat::index* it = col_begin ; it != col_end ; ++it, ++rows )
+		{
+			*it = *rows - 1;
+			if ( it != col_begin && *it < *(it-1) )is_sorted = false;
+		}
+		if ( !is_sorted )std::sort( col_begin, col_end );
+	}
+	offsets[n] = (phat::index)entries.size();
+
+	boundary_matrix.load_compressed( cell_dims, offsets, entries );
+}//load_boundary_matrix_from_CSR_input
+
+
+
+
+/**
+ * This is an auxiliary procedure that reduces the boundary matrix. If 
+ * max_homology_dim is nonnegative, only the pairs with a birth of dimension
+ * at most max_homology_dim are computed.
+**/ 
+template <typename PHAT_reduction_algorithm, typename PHAT_collumn_representation>
+void reduce_boundary_matrix_up_to_dimension
+(phat::persistence_pairs& pairs,
+phat::boundary_matrix<PHAT_collumn_representation >& boundary_matrix,
+const std::int64_t max_homology_dim)
+{
+	if ( max_homology_dim >= 0 )
+	{
+		phat::compute_persistence_pairs< PHAT_reduction_algorithm >( pairs, boundary_matrix, (phat::dimension)std::min( max_homology_dim, (std::int64_t)126 ) );
+	}
+	else
+	{
+		phat::compute_persistence_pairs< PHAT_reduction_algorithm >( pairs, boundary_matrix );
+	}
+}//reduce_boundary_matrix_up_to_dimension
+
+
+
+
 /**
  * This is an auxiliary procedure to create Phat boundary matrix and to 
  * reduce it. It is assumed to take as an input the encoded vector representing 
  * boundary matrix. Detailed description of the content of the vector can 
  * be found in the procedure body below. 
+ * If max_homology_dim is nonnegative, only the pairs with a birth of dimension
+ * at most max_homology_dim are computed, and cells of dimension above
+ * max_homology_dim + 1 are never reduced.
 **/ 
 template 
 <class RandomIt, 
@@ -286,70 +445,21 @@ reduce_boundary_matrix_with_phat_C_style_input
 (const std::uint64_t number_of_cells,
 const std::uint64_t dimension, 
 RandomIt xbegin, RandomIt xend,
-OutputIt rbegin )
+OutputIt rbegin,
+const std::int64_t max_homology_dim = -1 )
  {
-	 bool dbg = false;
-	 
 	//first define a boundary matrix with the chosen internal representation
 	phat::boundary_matrix<PHAT_collumn_representation > boundary_matrix;
 
-	//set the number of columns (equal to the size of compute_persistence_from_sparse_matrix)
-	boundary_matrix.set_num_cols( number_of_cells );	 
 	std::vector<unsigned> dimensions;
-	dimensions.reserve( number_of_cells );
-	 
-	std::size_t position = 0;				  
 	std::vector< phat::index > temp_col;    
-	for (std::size_t i = 0; i < number_of_cells; i++) 
-	{
-		//each cell is encoded in a vector by the following string:
-		//cell id (to check if it is equal i+1)
-		//dimension
-		//and then the sequence of boundary elements
-		//-1 indicate the end of a cell.
-
-		//first we check if the cell id  is the right one:
-		size_t cell_id = (size_t)xbegin[position];
-		assert ( i+1 == cell_id );
-		++position;
-
-		//we read the dimension of a cell and store it:
-		unsigned dimension_ = (unsigned)xbegin[position];	 
-		++position;
-
-		dimensions.push_back( dimension_ );
-		boundary_matrix.set_dim( i, dimension_ );
-		
-		if ( dbg )
-		{
-			std::cout << "This is a cell havng id : " << cell_id << " and dimension : " << dimension_ << " and the following boundary elements : " << std::endl;
-		}
-
-		//and now we read the vector of boundary
-		std::vector< unsigned > boundary;
-		boundary.reserve(20);
-		while ( xbegin[position] != -1 )
-		{
-		  //-1, since we convert from Julia to C++ style.		  
-		  temp_col.push_back( (unsigned)xbegin[position]-1 );
-		  if ( dbg )
-		  {
-			  std::cout << (unsigned)xbegin[position] << std::endl;
-		  }
-		  ++position;
-		}	  
-		boundary_matrix.set_col( i, temp_col );
-		temp_col.clear();
-
-		++position;	
-	}
- 
+	load_boundary_matrix_from_C_style_input( boundary_matrix, number_of_cells, xbegin, dimensions, temp_col );
 
     // define the object to hold the resulting persistence pairs
     phat::persistence_pairs pairs;
 
     //reduce the matrix.
-    phat::compute_persistence_pairs< PHAT_reduction_algorithm >( pairs, boundary_matrix );
+    reduce_boundary_matrix_up_to_dimension< PHAT_reduction_algorithm >( pairs, boundary_matrix, max_homology_dim );
     
     //sort the persistence pairs by birth index.
     pairs.sort();
@@ -380,11 +490,16 @@ OutputIt rbegin )
 
 
 
+/**
+ * Betti numbers in dimensions above a nonnegative max_homology_dim are not
+ * computed, they are reported as -1.
+**/ 
 template <class RandomIt, class OutputIt>
 OutputIt compute_betti_numbers(const std::uint64_t number_of_cells,
 					 const std::uint64_t dimension, 
 					 RandomIt xbegin, RandomIt xend,
-                     OutputIt rbegin) {   
+                     OutputIt rbegin,
+                     const std::int64_t max_homology_dim = -1) {   
      bool dbg = false;
      
      if ( dbg )
@@ -394,7 +509,7 @@ OutputIt compute_betti_numbers(const std::uint64_t number_of_cells,
      
 	std::pair<phat::persistence_pairs,std::vector<unsigned> > output_ = 
 	reduce_boundary_matrix_with_phat_C_style_input
-	(number_of_cells, dimension, xbegin, xend, rbegin);
+	(number_of_cells, dimension, xbegin, xend, rbegin, max_homology_dim);
 
 
 	phat::persistence_pairs pairs = output_.first;
@@ -428,6 +543,11 @@ OutputIt compute_betti_numbers(const std::uint64_t number_of_cells,
    
 	for ( size_t i = 0 ; i != result.size() ; ++i )
 	{
+	   if ( max_homology_dim >= 0 && (std::int64_t)i > max_homology_dim )
+	   {
+		   *rbegin++ = -1;
+		   continue;
+	   }
 	   *rbegin++ = result[i];
 	   //std::cerr << "result[i] : " << result[i] << std::endl;
 	}
@@ -439,11 +559,175 @@ OutputIt compute_betti_numbers(const std::uint64_t number_of_cells,
 
 
 
+/**
+ * This is an auxiliary procedure that writes the persistence intervals in the
+ * output format of compute_persistence_intervals: the pairs, -1, and then the
+ * creators of the infinite intervals. There are always number_of_cells + 1 
+ * numbers: with a nonnegative max_homology_dim the cells above it are not
+ * listed, and the remaining entries are set to -1, so a second -1 ends the
+ * creators of the infinite intervals. which_cells_were_not_reduced is a buffer 
+ * that can be reused between calls.
+**/ 
+template <class DimensionIt, class OutputIt>
+OutputIt write_persistence_intervals(const phat::persistence_pairs& pairs,
+const std::uint64_t number_of_cells,
+DimensionIt dimensions,
+OutputIt rbegin,
+const std::int64_t max_homology_dim,
+std::vector< bool >& which_cells_were_not_reduced)
+{
+	which_cells_were_not_reduced.assign( number_of_cells , false );
+	for( phat::index idx = 0; idx < pairs.get_num_pairs(); idx++ )
+	{
+		which_cells_were_not_reduced[ pairs.get_pair( idx ).first ] = true;
+		which_cells_were_not_reduced[ pairs.get_pair( idx ).second ] = true;
+		*rbegin++ =  pairs.get_pair( idx ).first;
+		*rbegin++ = pairs.get_pair( idx ).second;
+	}
+	*rbegin++ = -1;
+	std::uint64_t number_of_written = 2*pairs.get_num_pairs() + 1;
+	for ( size_t i = 0 ; i != which_cells_were_not_reduced.size() ; ++i )
+	{
+		if ( which_cells_were_not_reduced[i] )continue;//in this case, this cell is an element of a pair.
+		//classes above max_homology_dim were not computed, their cells are unpaired.
+		if ( max_homology_dim >= 0 && (std::int64_t)dimensions[i] > max_homology_dim )continue;
+		*rbegin++ = i;		
+		++number_of_written;
+	}
+	for ( ; number_of_written < number_of_cells + 1 ; ++number_of_written )
+	{
+		*rbegin++ = -1;
+	}
+	return rbegin;
+}//write_persistence_intervals
+
+
+
+
+
+/**
+ * This is an auxiliary procedure that writes the persistence intervals split
+ * by dimension: for every dimension d = 0, ..., dimension, first the finite 
+ * intervals of dimension d as pairs of creating and killing cell, sorted by 
+ * the creator, and then the creators of the infinite intervals of dimension d.
+ * dimension_offsets has 2*(dimension+1)+1 entries and is always filled: the
+ * finite intervals of dimension d are at rbegin[ dimension_offsets[2d] ], ...,
+ * rbegin[ dimension_offsets[2d+1] - 1 ], the infinite ones end before 
+ * dimension_offsets[2d+2]. The last offset is the required length of the 
+ * output. It is returned, and the intervals are only written if it does not 
+ * exceed capacity. It never exceeds number_of_cells. If an interval is created
+ * by a cell of dimension above dimension, nothing is written and -1 is returned.
+**/ 
+template <class DimensionIt, class OutputIt>
+std::int64_t write_persistence_intervals_by_dimension(const phat::persistence_pairs& pairs,
+const std::uint64_t number_of_cells,
+DimensionIt dimensions,
+const std::uint64_t dimension,
+const std::int64_t max_homology_dim,
+const std::int64_t capacity,
+OutputIt rbegin,
+std::int64_t* dimension_offsets,
+std::vector< bool >& which_cells_were_not_reduced)
+{
+	//first we count the intervals of every dimension.
+	std::vector< std::int64_t > number_of_finite( dimension+1, 0 ), number_of_infinite( dimension+1, 0 );
+	which_cells_were_not_reduced.assign( number_of_cells , false );
+	for( phat::index idx = 0; idx < pairs.get_num_pairs(); idx++ )
+	{
+		which_cells_were_not_reduced[ pairs.get_pair( idx ).first ] = true;
+		which_cells_were_not_reduced[ pairs.get_pair( idx ).second ] = true;
+		if ( (std::uint64_t)dimensions[ pairs.get_pair( idx ).first ] > dimension )return -1;
+		++number_of_finite[ dimensions[ pairs.get_pair( idx ).first ] ];
+	}
+	for ( size_t i = 0 ; i != which_cells_were_not_reduced.size() ; ++i )
+	{
+		if ( which_cells_were_not_reduced[i] )continue;
+		if ( max_homology_dim >= 0 && (std::int64_t)dimensions[i] > max_homology_dim )continue;
+		if ( (std::uint64_t)dimensions[i] > dimension )return -1;
+		++number_of_infinite[ dimensions[i] ];
+	}
+
+	dimension_offsets[0] = 0;
+	for ( size_t d = 0 ; d <= dimension ; ++d )
+	{
+		dimension_offsets[2*d+1] = dimension_offsets[2*d] + 2*number_of_finite[d];
+		dimension_offsets[2*d+2] = dimension_offsets[2*d+1] + number_of_infinite[d];
+	}
+	const std::int64_t required_length = dimension_offsets[2*dimension+2];
+	if ( required_length > capacity )return required_length;
+
+	//and now we write the intervals, every dimension has its own position.
+	std::vector< std::int64_t > position( dimension+1 );
+	for ( size_t d = 0 ; d <= dimension ; ++d )position[d] = dimension_offsets[2*d];
+	for( phat::index idx = 0; idx < pairs.get_num_pairs(); idx++ )
+	{
+		std::int64_t& pos = position[ dimensions[ pairs.get_pair( idx ).first ] ];
+		rbegin[pos++] = pairs.get_pair( idx ).first;
+		rbegin[pos++] = pairs.get_pair( idx ).second;
+	}
+	for ( size_t i = 0 ; i != which_cells_were_not_reduced.size() ; ++i )
+	{
+		if ( which_cells_were_not_reduced[i] )continue;
+		if ( max_homology_dim >= 0 && (std::int64_t)dimensions[i] > max_homology_dim )continue;
+		rbegin[ position[ dimensions[i] ]++ ] = i;
+	}
+	return required_length;
+}//write_persistence_intervals_by_dimension
+
+
+
+
+
+/**
+ * This is an auxiliary procedure that writes the Betti numbers in dimensions
+ * 0, ..., dimension, i.e. the numbers of cells of every dimension that are not 
+ * paired. The ones above a nonnegative max_homology_dim are -1. 
+ * which_cells_were_not_reduced is a buffer that can be reused between calls.
+**/ 
+template <class DimensionIt, class OutputIt>
+OutputIt write_betti_numbers(const phat::persistence_pairs& pairs,
+const std::uint64_t number_of_cells,
+DimensionIt dimensions,
+const std::uint64_t dimension,
+const std::int64_t max_homology_dim,
+OutputIt rbegin,
+std::vector< bool >& which_cells_were_not_reduced)
+{
+	std::vector< std::int64_t > result( dimension+1, 0 );
+	which_cells_were_not_reduced.assign( number_of_cells , false );
+	for( phat::index idx = 0; idx < pairs.get_num_pairs(); idx++ )
+	{
+		which_cells_were_not_reduced[ pairs.get_pair( idx ).first ] = true;
+		which_cells_were_not_reduced[ pairs.get_pair( idx ).second ] = true;
+	}
+	for ( size_t i = 0 ; i != which_cells_were_not_reduced.size() ; ++i )
+	{
+		if ( which_cells_were_not_reduced[i] )continue;
+		if ( (std::uint64_t)dimensions[i] > dimension )continue;
+		++result[ dimensions[i] ];
+	}
+
+	for ( size_t i = 0 ; i != result.size() ; ++i )
+	{
+		*rbegin++ = ( max_homology_dim >= 0 && (std::int64_t)i > max_homology_dim ) ? -1 : result[i];
+	}
+	return rbegin;
+}//write_betti_numbers
+
+
+
+
+/**
+ * With a nonnegative max_homology_dim, only the intervals of homology classes
+ * of dimension at most max_homology_dim are listed. The output has always 
+ * number_of_cells + 1 entries, see write_persistence_intervals. 
+**/ 
 template <class RandomIt, class OutputIt>
 OutputIt compute_persistence_intervals(const std::uint64_t number_of_cells,
 const std::uint64_t dimension,
 RandomIt xbegin, RandomIt xend,
-OutputIt rbegin) 
+OutputIt rbegin,
+const std::int64_t max_homology_dim = -1) 
 {  
     bool dbg = false;
      
@@ -454,35 +738,257 @@ OutputIt rbegin)
      
 	std::pair<phat::persistence_pairs,std::vector<unsigned> > output_ =
 	reduce_boundary_matrix_with_phat_C_style_input
-	(number_of_cells, dimension, xbegin, xend, rbegin);
+	(number_of_cells, dimension, xbegin, xend, rbegin, max_homology_dim);
 
 	phat::persistence_pairs pairs = output_.first;
+	std::vector<unsigned> dimensions = output_.second;
 
-	//check the maximal dimension involved:
-	std::vector< bool > which_cells_were_not_reduced( number_of_cells , false );
-	for( phat::index idx = 0; idx < pairs.get_num_pairs(); idx++ )
+	std::vector< bool > which_cells_were_not_reduced;
+	return write_persistence_intervals( pairs, number_of_cells, dimensions.begin(), rbegin, max_homology_dim, which_cells_were_not_reduced );
+}//compute_persistence_intervals
+
+
+
+
+/**
+ * This is the batched version of compute_persistence_intervals for many 
+ * independent complexes. Complex i has numbers_of_cells[i] cells, its encoding
+ * starts at xbegin[ input_offsets[i] ]. The complexes are reduced concurrently,
+ * every thread reuses its own boundary matrix and buffers. 
+ * The output of complex i is written in the format of compute_persistence_intervals 
+ * to rbegin[ output_offsets[i] ], ..., rbegin[ output_offsets[i+1] - 1 ] -- these are 
+ * numbers_of_cells[i] + 1 numbers, so rbegin needs room for the sum of them. 
+ * With a nonnegative max_homology_dim the entries after the listed intervals of
+ * a complex are -1 (see write_persistence_intervals), so the slices keep their size.
+ * output_offsets has number_of_complexes + 1 entries and is filled by this procedure.
+ * The pivot column representations keep one pivot column per OpenMP thread of 
+ * a single matrix, so every thread uses a vector_vector matrix of its own instead.
+**/ 
+template <class RandomIt, class OutputIt,
+typename PHAT_reduction_algorithm = phat::twist_reduction, 
+typename PHAT_collumn_representation = phat::vector_vector >
+void compute_persistence_intervals_batch(const std::uint64_t number_of_complexes,
+const std::uint64_t* numbers_of_cells,
+const std::uint64_t* input_offsets,
+RandomIt xbegin,
+OutputIt rbegin,
+std::int64_t* output_offsets,
+const std::int64_t max_homology_dim = -1)
+{
+	output_offsets[0] = 0;
+	for ( std::uint64_t i = 0 ; i != number_of_complexes ; ++i )
 	{
-		which_cells_were_not_reduced[ pairs.get_pair( idx ).first ] = true;
-		which_cells_were_not_reduced[ pairs.get_pair( idx ).second ] = true;
-		*rbegin++ =  pairs.get_pair( idx ).first;
-		*rbegin++ = pairs.get_pair( idx ).second;
-		if ( dbg )
+		output_offsets[i+1] = output_offsets[i] + (std::int64_t)numbers_of_cells[i] + 1;
+	}
+
+	#pragma omp parallel
+	{
+		//buffers of this thread, reused for all of its complexes.
+		phat::boundary_matrix<PHAT_collumn_representation > boundary_matrix;
+		std::vector<unsigned> dimensions;
+		std::vector< phat::index > temp_col;
+		std::vector< bool > which_cells_were_not_reduced;
+		phat::persistence_pairs pairs;
+
+		#pragma omp for schedule( dynamic, 1 )
+		for ( std::int64_t i = 0 ; i < (std::int64_t)number_of_complexes ; ++i )
 		{
-			std::cout << "( " << pairs.get_pair( idx ).first << " , " << pairs.get_pair( idx ).second << " ) ";
+			load_boundary_matrix_from_C_style_input( boundary_matrix, numbers_of_cells[i], xbegin + input_offsets[i], dimensions, temp_col );
+			reduce_boundary_matrix_up_to_dimension< PHAT_reduction_algorithm >( pairs, boundary_matrix, max_homology_dim );
+			pairs.sort();
+			write_persistence_intervals( pairs, numbers_of_cells[i], dimensions.begin(), rbegin + output_offsets[i], max_homology_dim, which_cells_were_not_reduced );
 		}
 	}
-	*rbegin++ = -1;
-	for ( size_t i = 0 ; i != which_cells_were_not_reduced.size() ; ++i )
+}//compute_persistence_intervals_batch
+
+
+
+
+/**
+ * These are the versions of compute_persistence_intervals and 
+ * compute_betti_numbers for a boundary matrix in the compressed sparse column
+ * format (see load_boundary_matrix_from_CSR_input), e.g. the colptr, rowval 
+ * arrays of a SparseMatrixCSC and the dimensions of the cells. The output 
+ * formats are the same as for the procedures above.
+**/ 
+template <class OutputIt,
+typename PHAT_reduction_algorithm = phat::twist_reduction, 
+typename PHAT_collumn_representation = phat::bit_tree_pivot_column >
+OutputIt compute_persistence_intervals_CSR(const std::uint64_t number_of_cells,
+const std::int64_t* col_ptr,
+const std::int64_t* row_idx,
+const std::int64_t* dims,
+OutputIt rbegin,
+const std::int64_t max_homology_dim = -1)
+{
+	phat::boundary_matrix<PHAT_collumn_representation > boundary_matrix;
+	load_boundary_matrix_from_CSR_input( boundary_matrix, number_of_cells, col_ptr, row_idx, dims );
+
+	phat::persistence_pairs pairs;
+	reduce_boundary_matrix_up_to_dimension< PHAT_reduction_algorithm >( pairs, boundary_matrix, max_homology_dim );
+	pairs.sort();
+
+	std::vector< bool > which_cells_were_not_reduced;
+	return write_persistence_intervals( pairs, number_of_cells, dims, rbegin, max_homology_dim, which_cells_were_not_reduced );
+}//compute_persistence_intervals_CSR
+
+
+
+template <class OutputIt,
+typename PHAT_reduction_algorithm = phat::twist_reduction, 
+typename PHAT_collumn_representation = phat::bit_tree_pivot_column >
+OutputIt compute_betti_numbers_CSR(const std::uint64_t number_of_cells,
+const std::uint64_t dimension,
+const std::int64_t* col_ptr,
+const std::int64_t* row_idx,
+const std::int64_t* dims,
+OutputIt rbegin,
+const std::int64_t max_homology_dim = -1)
+{
+	phat::boundary_matrix<PHAT_collumn_representation > boundary_matrix;
+	load_boundary_matrix_from_CSR_input( boundary_matrix, number_of_cells, col_ptr, row_idx, dims );
+
+	phat::persistence_pairs pairs;
+	reduce_boundary_matrix_up_to_dimension< PHAT_reduction_algorithm >( pairs, boundary_matrix, max_homology_dim );
+
+	std::vector< bool > which_cells_were_not_reduced;
+	return write_betti_numbers( pairs, number_of_cells, dims, dimension, max_homology_dim, rbegin, which_cells_were_not_reduced );
+}//compute_betti_numbers_CSR
+
+
+
+
+/**
+ * These are the versions of compute_persistence_intervals and 
+ * compute_persistence_intervals_CSR that write the intervals split by 
+ * dimension into an output of the given capacity, see 
+ * write_persistence_intervals_by_dimension. They return the required length 
+ * of the output, so a capacity of number_of_cells is always enough.
+**/ 
+template <class RandomIt, class OutputIt>
+std::int64_t compute_persistence_intervals_by_dimension(const std::uint64_t number_of_cells,
+const std::uint64_t dimension,
+RandomIt xbegin, RandomIt xend,
+const std::int64_t capacity,
+OutputIt rbegin,
+std::int64_t* dimension_offsets,
+const std::int64_t max_homology_dim = -1)
+{
+	std::pair<phat::persistence_pairs,std::vector<unsigned> > output_ =
+	reduce_boundary_matrix_with_phat_C_style_input
+	(number_of_cells, dimension, xbegin, xend, rbegin, max_homology_dim);
+
+	std::vector< bool > which_cells_were_not_reduced;
+	return write_persistence_intervals_by_dimension( output_.first, number_of_cells, output_.second.begin(), dimension, max_homology_dim, capacity, rbegin, dimension_offsets, which_cells_were_not_reduced );
+}//compute_persistence_intervals_by_dimension
+
+
+
+template <class OutputIt,
+typename PHAT_reduction_algorithm = phat::twist_reduction, 
+typename PHAT_collumn_representation = phat::bit_tree_pivot_column >
+std::int64_t compute_persistence_intervals_by_dimension_CSR(const std::uint64_t number_of_cells,
+const std::uint64_t dimension,
+const std::int64_t* col_ptr,
+const std::int64_t* row_idx,
+const std::int64_t* dims,
+const std::int64_t capacity,
+OutputIt rbegin,
+std::int64_t* dimension_offsets,
+const std::int64_t max_homology_dim = -1)
+{
+	phat::boundary_matrix<PHAT_collumn_representation > boundary_matrix;
+	load_boundary_matrix_from_CSR_input( boundary_matrix, number_of_cells, col_ptr, row_idx, dims );
+
+	phat::persistence_pairs pairs;
+	reduce_boundary_matrix_up_to_dimension< PHAT_reduction_algorithm >( pairs, boundary_matrix, max_homology_dim );
+	pairs.sort();
+
+	std::vector< bool > which_cells_were_not_reduced;
+	return write_persistence_intervals_by_dimension( pairs, number_of_cells, dims, dimension, max_homology_dim, capacity, rbegin, dimension_offsets, which_cells_were_not_reduced );
+}//compute_persistence_intervals_by_dimension_CSR
+
+
+
+
+/**
+ * A reduction session keeps a boundary matrix alive between calls: the columns,
+ * the pivot columns of the representation and all the buffers are reused when
+ * another complex is loaded into it, so a sequence of similar-sized complexes 
+ * does not allocate them again and again. Cells can also be appended after a 
+ * reduction; the next reduction then only reduces the appended cells against
+ * the already reduced matrix (see phat::incremental_reduction).
+ * The max_homology_dim of the first reduction after a load applies to the 
+ * appended cells as well.
+**/ 
+template <typename PHAT_reduction_algorithm = phat::twist_reduction, 
+typename PHAT_collumn_representation = phat::bit_tree_pivot_column >
+class reduction_session
+{
+public:
+	reduction_session():max_homology_dim(-1){}
+
+	std::uint64_t get_number_of_cells()const{ return dimensions.size(); }
+	std::uint64_t get_number_of_reduced_cells()const{ return reduction.get_num_reduced_cols(); }
+	
+	template <class RandomIt>
+	void load( const std::uint64_t number_of_cells, RandomIt xbegin )
 	{
-		if ( which_cells_were_not_reduced[i] )continue;//in this case, this cell is an element of a pair.
-		*rbegin++ = i;		
-		if ( dbg )
+		load_boundary_matrix_from_C_style_input( reduction.get_boundary_matrix(), number_of_cells, xbegin, dimensions, temp_col );
+		reduction.restart();
+		pairs.clear();
+	}
+	
+	void load_CSR( const std::uint64_t number_of_cells, const std::int64_t* col_ptr, const std::int64_t* row_idx, const std::int64_t* dims )
+	{
+		load_boundary_matrix_from_CSR_input( reduction.get_boundary_matrix(), number_of_cells, col_ptr, row_idx, dims );
+		dimensions.assign( dims, dims + number_of_cells );
+		reduction.restart();
+		pairs.clear();
+	}
+	
+	//the appended cells are numbered from get_number_of_cells()+1 in the encoded vector.
+	template <class RandomIt>
+	void append( const std::uint64_t number_of_cells, RandomIt xbegin )
+	{
+		std::size_t position = 0;
+		for (std::size_t i = 0; i < number_of_cells; i++) 
 		{
-			std::cout << "Infinite interval starting at  " << i << " ";
+			unsigned dimension_;
+			read_cell_from_C_style_input( xbegin, position, get_number_of_cells(), dimension_, temp_col );
+			dimensions.push_back( dimension_ );
+			reduction.append_column( (phat::dimension)dimension_, temp_col );
 		}
 	}
-	return rbegin;
-}//compute_persistence_intervals
+	
+	//reduces the cells that were loaded or appended since the last reduction.
+	void reduce( const std::int64_t max_homology_dim_ = -1 )
+	{
+		if ( reduction.get_num_reduced_cols() == 0 )max_homology_dim = max_homology_dim_;
+		reduction.reduce( pairs, (phat::dimension)std::min( max_homology_dim_, (std::int64_t)126 ) );
+		pairs.sort();
+	}
+	
+	template <class OutputIt>
+	OutputIt get_betti_numbers( const std::uint64_t dimension, OutputIt rbegin )
+	{
+		return write_betti_numbers( pairs, get_number_of_reduced_cells(), dimensions.begin(), dimension, max_homology_dim, rbegin, which_cells_were_not_reduced );
+	}
+	
+	template <class OutputIt>
+	std::int64_t get_persistence_intervals_by_dimension( const std::uint64_t dimension, const std::int64_t capacity, OutputIt rbegin, std::int64_t* dimension_offsets )
+	{
+		return write_persistence_intervals_by_dimension( pairs, get_number_of_reduced_cells(), dimensions.begin(), dimension, max_homology_dim, capacity, rbegin, dimension_offsets, which_cells_were_not_reduced );
+	}
+	
+protected:
+	phat::incremental_reduction< PHAT_collumn_representation, PHAT_reduction_algorithm > reduction;
+	std::vector<unsigned> dimensions;
+	std::vector< phat::index > temp_col;
+	std::vector< bool > which_cells_were_not_reduced;
+	phat::persistence_pairs pairs;
+	std::int64_t max_homology_dim;
+};//reduction_session
 
 
 
@@ -540,6 +1046,232 @@ extern "C"
 		xbegin + number_of_cells, 
 		rbegin);
 	}
+	
+	
+	
+	//The same as compute_betti_numbers, but only Betti numbers up to max_homology_dim are computed.
+	//The remaining entries of the result are -1.
+	void compute_betti_numbers_up_to_dimension(const std::uint64_t number_of_cells /* use fixed-size integers */,
+					 const std::uint64_t dimension /* use fixed-size integers */,
+					 const std::int64_t max_homology_dim /* use fixed-size integers */,
+					 const std::uint64_t *xbegin /* use fixed-size integers */,
+					 std::int64_t *rbegin /* use fixed-size integers */) 
+	{
+		compute_betti_numbers
+		(number_of_cells, 
+		dimension,
+		xbegin, 
+		xbegin + number_of_cells, 
+		rbegin,
+		max_homology_dim);
+	}
+	
+	
+	
+	//Computes the persistence intervals of number_of_complexes complexes concurrently,
+	//see the compute_persistence_intervals_batch procedure above for the arguments.
+	//A negative max_homology_dim computes all intervals, otherwise the entries after the
+	//listed intervals of a complex are -1.
+	void compute_persistence_intervals_batch(const std::uint64_t number_of_complexes /* use fixed-size integers */,
+	const std::uint64_t *numbers_of_cells /* use fixed-size integers */,
+	const std::uint64_t *input_offsets /* use fixed-size integers */,
+	const std::int64_t max_homology_dim /* use fixed-size integers */,
+	const std::uint64_t *xbegin /* use fixed-size integers */,
+	std::int64_t *rbegin /* use fixed-size integers */,
+	std::int64_t *output_offsets /* use fixed-size integers */) 
+	{
+		compute_persistence_intervals_batch
+		(number_of_complexes,
+		numbers_of_cells,
+		input_offsets,
+		xbegin,
+		rbegin,
+		output_offsets,
+		max_homology_dim);
+	}
+	
+	
+	
+	//The same as compute_persistence_intervals, but only intervals up to max_homology_dim are computed.
+	//rbegin still needs number_of_cells + 1 entries, the ones after the listed intervals are -1.
+	void compute_persistence_intervals_up_to_dimension(const std::uint64_t number_of_cells /* use fixed-size integers */,
+	const std::uint64_t dimension /* use fixed-size integers */,
+	const std::int64_t max_homology_dim /* use fixed-size integers */,
+	const std::uint64_t *xbegin /* use fixed-size integers */,
+	std::int64_t *rbegin /* use fixed-size integers */) 
+	{
+		compute_persistence_intervals
+		(number_of_cells, 
+		dimension,
+		xbegin, 
+		xbegin + number_of_cells, 
+		rbegin,
+		max_homology_dim);
+	}
+	
+	
+	
+	//Computes the persistence intervals of a boundary matrix given by the colptr and rowval
+	//arrays of a Julia SparseMatrixCSC and the dimensions of the cells, all of them Int64
+	//and 1-based. The output is the same as for compute_persistence_intervals, so rbegin 
+	//needs number_of_cells + 1 entries. A negative max_homology_dim computes all intervals,
+	//otherwise the entries after the listed intervals are -1.
+	void compute_persistence_intervals_csr(const std::uint64_t number_of_cells /* use fixed-size integers */,
+	const std::int64_t *col_ptr /* use fixed-size integers */,
+	const std::int64_t *row_idx /* use fixed-size integers */,
+	const std::int64_t *dims /* use fixed-size integers */,
+	const std::int64_t max_homology_dim /* use fixed-size integers */,
+	std::int64_t *rbegin /* use fixed-size integers */) 
+	{
+		compute_persistence_intervals_CSR
+		(number_of_cells,
+		col_ptr,
+		row_idx,
+		dims,
+		rbegin,
+		max_homology_dim);
+	}
+	
+	
+	
+	//The same as compute_betti_numbers_up_to_dimension for the input of compute_persistence_intervals_csr.
+	void compute_betti_numbers_csr(const std::uint64_t number_of_cells /* use fixed-size integers */,
+	const std::uint64_t dimension /* use fixed-size integers */,
+	const std::int64_t *col_ptr /* use fixed-size integers */,
+	const std::int64_t *row_idx /* use fixed-size integers */,
+	const std::int64_t *dims /* use fixed-size integers */,
+	const std::int64_t max_homology_dim /* use fixed-size integers */,
+	std::int64_t *rbegin /* use fixed-size integers */) 
+	{
+		compute_betti_numbers_CSR
+		(number_of_cells,
+		dimension,
+		col_ptr,
+		row_idx,
+		dims,
+		rbegin,
+		max_homology_dim);
+	}
+	
+	
+	
+	//Computes the persistence intervals split by dimension into rbegin, which has room for 
+	//capacity numbers, and fills dimension_offsets (2*dimension+3 entries), see 
+	//write_persistence_intervals_by_dimension. Returns the required length of rbegin; if it
+	//exceeds capacity, rbegin is left untouched. A capacity of number_of_cells is always enough.
+	//Returns -1 if an interval has a dimension above dimension.
+	std::int64_t compute_persistence_intervals_by_dimension(const std::uint64_t number_of_cells /* use fixed-size integers */,
+	const std::uint64_t dimension /* use fixed-size integers */,
+	const std::int64_t max_homology_dim /* use fixed-size integers */,
+	const std::uint64_t *xbegin /* use fixed-size integers */,
+	const std::int64_t capacity /* use fixed-size integers */,
+	std::int64_t *rbegin /* use fixed-size integers */,
+	std::int64_t *dimension_offsets /* use fixed-size integers */) 
+	{
+		return compute_persistence_intervals_by_dimension
+		(number_of_cells, 
+		dimension,
+		xbegin, 
+		xbegin + number_of_cells, 
+		capacity,
+		rbegin,
+		dimension_offsets,
+		max_homology_dim);
+	}
+	
+	
+	
+	//The same as compute_persistence_intervals_by_dimension for the input of compute_persistence_intervals_csr.
+	std::int64_t compute_persistence_intervals_by_dimension_csr(const std::uint64_t number_of_cells /* use fixed-size integers */,
+	const std::uint64_t dimension /* use fixed-size integers */,
+	const std::int64_t *col_ptr /* use fixed-size integers */,
+	const std::int64_t *row_idx /* use fixed-size integers */,
+	const std::int64_t *dims /* use fixed-size integers */,
+	const std::int64_t max_homology_dim /* use fixed-size integers */,
+	const std::int64_t capacity /* use fixed-size integers */,
+	std::int64_t *rbegin /* use fixed-size integers */,
+	std::int64_t *dimension_offsets /* use fixed-size integers */) 
+	{
+		return compute_persistence_intervals_by_dimension_CSR
+		(number_of_cells,
+		dimension,
+		col_ptr,
+		row_idx,
+		dims,
+		capacity,
+		rbegin,
+		dimension_offsets,
+		max_homology_dim);
+	}
+	
+	
+	
+	//A reduction session (see the reduction_session class above) behind an opaque pointer.
+	//It is created by phat_session_create and has to be released by phat_session_destroy.
+	//phat_session_load and phat_session_load_csr replace the complex of the session, 
+	//phat_session_append adds cells numbered from the current number of cells + 1.
+	//phat_session_reduce reduces the cells added since the last reduction, the queries
+	//have the output formats of compute_betti_numbers_up_to_dimension and 
+	//compute_persistence_intervals_by_dimension and refer to the reduced cells.
+	void* phat_session_create() 
+	{
+		return new reduction_session<>();
+	}
+	
+	void phat_session_destroy(void* session) 
+	{
+		delete (reduction_session<>*)session;
+	}
+	
+	void phat_session_load(void* session,
+	const std::uint64_t number_of_cells /* use fixed-size integers */,
+	const std::uint64_t *xbegin /* use fixed-size integers */) 
+	{
+		((reduction_session<>*)session)->load( number_of_cells, xbegin );
+	}
+	
+	void phat_session_load_csr(void* session,
+	const std::uint64_t number_of_cells /* use fixed-size integers */,
+	const std::int64_t *col_ptr /* use fixed-size integers */,
+	const std::int64_t *row_idx /* use fixed-size integers */,
+	const std::int64_t *dims /* use fixed-size integers */) 
+	{
+		((reduction_session<>*)session)->load_CSR( number_of_cells, col_ptr, row_idx, dims );
+	}
+	
+	void phat_session_append(void* session,
+	const std::uint64_t number_of_cells /* use fixed-size integers */,
+	const std::uint64_t *xbegin /* use fixed-size integers */) 
+	{
+		((reduction_session<>*)session)->append( number_of_cells, xbegin );
+	}
+	
+	void phat_session_reduce(void* session,
+	const std::int64_t max_homology_dim /* use fixed-size integers */) 
+	{
+		((reduction_session<>*)session)->reduce( max_homology_dim );
+	}
+	
+	std::uint64_t phat_session_number_of_cells(void* session) 
+	{
+		return ((reduction_session<>*)session)->get_number_of_cells();
+	}
+	
+	void phat_session_betti_numbers(void* session,
+	const std::uint64_t dimension /* use fixed-size integers */,
+	std::int64_t *rbegin /* use fixed-size integers */) 
+	{
+		((reduction_session<>*)session)->get_betti_numbers( dimension, rbegin );
+	}
+	
+	std::int64_t phat_session_persistence_intervals_by_dimension(void* session,
+	const std::uint64_t dimension /* use fixed-size integers */,
+	const std::int64_t capacity /* use fixed-size integers */,
+	std::int64_t *rbegin /* use fixed-size integers */,
+	std::int64_t *dimension_offsets /* use fixed-size integers */) 
+	{
+		return ((reduction_session<>*)session)->get_persistence_intervals_by_dimension( dimension, capacity, rbegin, dimension_offsets );
+	}
 }
 
 
@@ -588,6 +1320,13 @@ const libhandle = Libdl.dlopen(joinpath(pwd(), "interface_with_julia.so"))
 //here are the options for functions to use to compute Betti numbers or persistence:
 const funhandle = Libdl.dlsym(libhandle, :compute_betti_numbers_not_optimal) //non optymality is here because the boundary matrix is stored twice (once as vector, and the other time as phat boundary matrix).
 const funhandle = Libdl.dlsym(libhandle, :compute_betti_numbers)
+const funhandle = Libdl.dlsym(libhandle, :compute_betti_numbers_up_to_dimension) //takes max_homology_dim::Int64 as an additional third argument, Betti numbers above it are -1.
+const funhandle = Libdl.dlsym(libhandle, :compute_persistence_intervals_up_to_dimension) //takes max_homology_dim::Int64 as an additional third argument, the unused entries at the end of the result are -1.
+const funhandle = Libdl.dlsym(libhandle, :compute_persistence_intervals_batch) //reduces many complexes at once, see compute_persistence_intervals_batch for the arguments.
+const funhandle = Libdl.dlsym(libhandle, :compute_persistence_intervals_csr) //takes the colptr and rowval of a SparseMatrixCSC and the dimensions of the cells instead of the -1 separated array, see below.
+const funhandle = Libdl.dlsym(libhandle, :compute_betti_numbers_csr) //the same for Betti numbers.
+const funhandle = Libdl.dlsym(libhandle, :compute_persistence_intervals_by_dimension) //writes the intervals split by dimension into a buffer of a given capacity and returns the required length, see below.
+const session = ccall(Libdl.dlsym(libhandle, :phat_session_create), Ptr{Void}, ()) //keeps the matrix and its buffers between calls, see the phat_session_* functions.
 const funhandle = Libdl.dlsym(libhandle, :compute_persistence_intervals)  //the output of this function is a vector of creating cell and killing cell, creatinc cell and killing cell etc etc.
 																		  //The infinite pairs comes at the end, they are separated from the other pairs by -1. In this case, each id of a cell that comes after -1 is a creator of infinite homology class
 																		  //REMEMBER that when computing persistence intervals, the size of the array have to be the number of cells + 1 (to store the -1 to separate finite from infinite pairs!!)
@@ -608,7 +1347,26 @@ end
 cells = [1 0 -1 2 0 -1 3 0 -1 4 0 -1 5 1 1 4 -1 6 1 4 3 -1 7 1 2 3 -1 8 1 1 2 -1]
 
 result = compute(convert(UInt64,8),convert(UInt64,2),cells)
-* 
+
+
+The same square as a SparseMatrixCSC, for compute_persistence_intervals_csr:
+
+B = sparse([1,4,4,3,2,3,1,2], [5,5,6,6,7,7,8,8], ones(Int64,8), 8, 8)
+dims = Int64[0,0,0,0,1,1,1,1]
+result = Vector{Int64}(size(B,2)+1)
+ccall(funhandle, Void, (UInt64, Ref{Int64}, Ref{Int64}, Ref{Int64}, Int64, Ref{Int64}),
+      size(B,2), B.colptr, B.rowval, dims, -1, result)
+
+
+With compute_persistence_intervals_by_dimension the output never runs past the buffer. The
+intervals of dimension d are result[offsets[2d+1]+1:offsets[2d+2]] (finite, as pairs) and 
+result[offsets[2d+2]+1:offsets[2d+3]] (infinite), and the return value is the length used:
+
+result = Vector{Int64}(number_of_cells)
+offsets = Vector{Int64}(2*dimension+3)
+used = ccall(funhandle, Int64, (UInt64, UInt64, Int64, Ref{Int64}, Int64, Ref{Int64}, Ref{Int64}),
+             number_of_cells, dimension, -1, A, length(result), result, offsets)
+*
 * 
 THIS IS HOW TO DO IT VIA INTERFACE THAT USES C++ VIA Cxx:
  
@@ -73,6 +73,184 @@ int main( int argc, char** argv )
 	{
 		std::cout << intervals[i].first << " " << intervals[i].second << std::endl;
 	}
+	//Now the batched interface with the C style encoding: for every cell its 
+	//id, dimension, boundary and -1 (counting from 1). We reduce the square 
+	//above and a filled triangle at once and only compute the intervals of 
+	//dimension 0, so the slice of the triangle is padded with -1.
+	const std::uint64_t end_of_cell = (std::uint64_t)-1;
+	std::uint64_t square[] = { 1,0,end_of_cell, 2,0,end_of_cell, 3,0,end_of_cell, 4,0,end_of_cell, 
+	                           5,1,1,2,end_of_cell, 6,1,2,3,end_of_cell, 7,1,3,4,end_of_cell, 8,1,1,4,end_of_cell };
+	std::uint64_t triangle[] = { 1,0,end_of_cell, 2,0,end_of_cell, 3,0,end_of_cell, 
+	                             4,1,1,2,end_of_cell, 5,1,2,3,end_of_cell, 6,1,1,3,end_of_cell, 7,2,4,5,6,end_of_cell };
+	std::vector< std::uint64_t > batch_input( square, square + sizeof( square )/sizeof( square[0] ) );
+	batch_input.insert( batch_input.end(), triangle, triangle + sizeof( triangle )/sizeof( triangle[0] ) );
+	std::uint64_t numbers_of_cells[] = { 8, 7 };
+	std::uint64_t input_offsets[] = { 0, sizeof( square )/sizeof( square[0] ) };
+	std::int64_t output_offsets[3];
+	//777 marks the entries that were not written.
+	std::vector< std::int64_t > batch_intervals( 8+1 + 7+1, 777 );
+	compute_persistence_intervals_batch( 2, numbers_of_cells, input_offsets, 0, batch_input.data(), batch_intervals.data(), output_offsets );
+
+	std::cout << "Intervals of dimension 0 of the square and of a filled triangle : \n";
+	bool is_batch_correct = true;
+	for ( size_t i = 0 ; i != 2 ; ++i )
+	{
+		std::vector< std::int64_t > intervals_of_complex( numbers_of_cells[i]+1, 777 );
+		compute_persistence_intervals_up_to_dimension( numbers_of_cells[i], 2, 0, batch_input.data() + input_offsets[i], intervals_of_complex.data() );
+		for ( std::int64_t j = output_offsets[i] ; j != output_offsets[i+1] ; ++j )
+		{
+			std::cout << batch_intervals[j] << " ";
+			if ( batch_intervals[j] != intervals_of_complex[ j-output_offsets[i] ] )is_batch_correct = false;
+		}
+		std::cout << std::endl;
+		if ( std::count( intervals_of_complex.begin(), intervals_of_complex.end(), 777 ) != 0 )is_batch_correct = false;
+	}
+	if ( !is_batch_correct || std::count( batch_intervals.begin(), batch_intervals.end(), 777 ) != 0 )
+	{
+		std::cout << "Error: the batched intervals are not the intervals of the single complexes! \n";
+		return 1;
+	}
+	
+	//The square once more, as the colptr, rowval arrays of a SparseMatrixCSC 
+	//(counting from 1) and the dimensions of the cells. The boundaries of the 
+	//cells 6 and 8 are not sorted.
+	std::int64_t col_ptr[] = { 1,1,1,1,1,3,5,7,9 };
+	std::int64_t row_idx[] = { 1,2, 3,2, 3,4, 4,1 };
+	std::int64_t dims[] = { 0,0,0,0,1,1,1,1 };
+	std::vector< std::int64_t > csr_intervals( 8+1, 777 ), square_intervals( 8+1, 777 );
+	compute_persistence_intervals_csr( 8, col_ptr, row_idx, dims, -1, csr_intervals.data() );
+	compute_persistence_intervals( 8, 1, square, square_intervals.data() );
+	std::vector< std::int64_t > csr_betti( 2, 777 ), square_betti( 2, 777 );
+	compute_betti_numbers_csr( 8, 1, col_ptr, row_idx, dims, -1, csr_betti.data() );
+	compute_betti_numbers( 8, 1, square, square_betti.data() );
+	
+	std::cout << "Intervals and Betti numbers of the square from the CSR input : \n";
+	for ( size_t i = 0 ; i != csr_intervals.size() ; ++i )std::cout << csr_intervals[i] << " ";
+	std::cout << std::endl;
+	for ( size_t i = 0 ; i != csr_betti.size() ; ++i )std::cout << csr_betti[i] << " ";
+	std::cout << std::endl;
+	if ( csr_intervals != square_intervals || std::count( csr_intervals.begin(), csr_intervals.end(), 777 ) != 0 
+	     || csr_betti != square_betti || std::count( csr_betti.begin(), csr_betti.end(), 777 ) != 0 )
+	{
+		std::cout << "Error: the CSR input gives other results than the C style input! \n";
+		return 1;
+	}
+	
+	//The intervals of the square split by dimension, from the C style and the 
+	//CSR input. They only fit into a buffer of the required length, a smaller 
+	//one is left untouched, and a dimension below the one of the cycle of the 
+	//square is rejected. The slices have to match the intervals above.
+	std::cout << "Intervals of the square by dimension : \n";
+	for ( size_t is_csr = 0 ; is_csr != 2 ; ++is_csr )
+	{
+		std::vector< std::int64_t > split_intervals( 8, 777 ), dimension_offsets( 2*1+3, 777 );
+		std::int64_t required_length = is_csr ? 
+		compute_persistence_intervals_by_dimension_csr( 8, 1, col_ptr, row_idx, dims, -1, 0, split_intervals.data(), dimension_offsets.data() ) :
+		compute_persistence_intervals_by_dimension( 8, 1, -1, square, 0, split_intervals.data(), dimension_offsets.data() );
+		std::int64_t smaller_length = is_csr ? 
+		compute_persistence_intervals_by_dimension_csr( 8, 1, col_ptr, row_idx, dims, -1, required_length-1, split_intervals.data(), dimension_offsets.data() ) :
+		compute_persistence_intervals_by_dimension( 8, 1, -1, square, required_length-1, split_intervals.data(), dimension_offsets.data() );
+		if ( required_length != 8 || smaller_length != required_length || std::count( split_intervals.begin(), split_intervals.end(), 777 ) != 8 )
+		{
+			std::cout << "Error: a too small buffer was written or the wrong length was returned! \n";
+			return 1;
+		}
+		std::int64_t too_small_dimension = is_csr ? 
+		compute_persistence_intervals_by_dimension_csr( 8, 0, col_ptr, row_idx, dims, -1, 8, split_intervals.data(), dimension_offsets.data() ) :
+		compute_persistence_intervals_by_dimension( 8, 0, -1, square, 8, split_intervals.data(), dimension_offsets.data() );
+		if ( too_small_dimension != -1 || std::count( split_intervals.begin(), split_intervals.end(), 777 ) != 8 )
+		{
+			std::cout << "Error: the intervals above the given dimension were not rejected! \n";
+			return 1;
+		}
+		std::int64_t used_length = is_csr ? 
+		compute_persistence_intervals_by_dimension_csr( 8, 1, col_ptr, row_idx, dims, -1, 8, split_intervals.data(), dimension_offsets.data() ) :
+		compute_persistence_intervals_by_dimension( 8, 1, -1, square, 8, split_intervals.data(), dimension_offsets.data() );
+		
+		//the intervals of the unsplit output in the order of the slices.
+		std::vector< std::int64_t > expected_intervals;
+		size_t end_of_pairs = std::find( square_intervals.begin(), square_intervals.end(), -1 ) - square_intervals.begin();
+		for ( std::int64_t d = 0 ; d <= 1 ; ++d )
+		{
+			for ( size_t i = 0 ; i < end_of_pairs ; i += 2 )
+			{
+				if ( dims[ square_intervals[i] ] == d )
+				{
+					expected_intervals.push_back( square_intervals[i] );
+					expected_intervals.push_back( square_intervals[i+1] );
+				}
+			}
+			if ( dimension_offsets[2*d+1] != (std::int64_t)expected_intervals.size() )used_length = -1;
+			for ( size_t i = end_of_pairs+1 ; i != square_intervals.size() ; ++i )
+			{
+				if ( dims[ square_intervals[i] ] == d )expected_intervals.push_back( square_intervals[i] );
+			}
+			if ( dimension_offsets[2*d+2] != (std::int64_t)expected_intervals.size() )used_length = -1;
+		}
+		for ( std::int64_t i = 0 ; i != dimension_offsets[4] ; ++i )std::cout << split_intervals[i] << " ";
+		std::cout << std::endl;
+		if ( used_length != required_length || dimension_offsets[0] != 0 
+		     || !std::equal( expected_intervals.begin(), expected_intervals.end(), split_intervals.begin() ) )
+		{
+			std::cout << "Error: the intervals by dimension are not the intervals of the square! \n";
+			return 1;
+		}
+	}
+	
+	//A reduction session: the vertices of the filled triangle are loaded and 
+	//reduced first, then its edges and its face are appended and reduced. The 
+	//result has to be the one of the whole triangle at once. Then the session
+	//is reused for the square in the CSR format, up to dimension 0.
+	void* session = phat_session_create();
+	phat_session_load( session, 3, triangle );
+	phat_session_reduce( session, -1 );
+	phat_session_append( session, 3, triangle + 9 );
+	phat_session_append( session, 1, triangle + 24 );
+	phat_session_reduce( session, -1 );
+	
+	std::vector< std::int64_t > session_betti( 3, 777 ), triangle_betti( 3, 777 );
+	std::vector< std::int64_t > session_intervals( 7, 777 ), session_offsets( 2*2+3, 777 );
+	std::vector< std::int64_t > triangle_intervals( 7, 777 ), triangle_offsets( 2*2+3, 777 );
+	phat_session_betti_numbers( session, 2, session_betti.data() );
+	std::int64_t session_length = phat_session_persistence_intervals_by_dimension( session, 2, 7, session_intervals.data(), session_offsets.data() );
+	compute_betti_numbers( 7, 2, triangle, triangle_betti.data() );
+	std::int64_t triangle_length = compute_persistence_intervals_by_dimension( 7, 2, -1, triangle, 7, triangle_intervals.data(), triangle_offsets.data() );
+	
+	std::cout << "Betti numbers and intervals of the triangle built in a session : \n";
+	for ( size_t i = 0 ; i != session_betti.size() ; ++i )std::cout << session_betti[i] << " ";
+	std::cout << std::endl;
+	for ( std::int64_t i = 0 ; i < session_length ; ++i )std::cout << session_intervals[i] << " ";
+	std::cout << std::endl;
+	if ( phat_session_number_of_cells( session ) != 7 || session_betti != triangle_betti || session_length != triangle_length
+	     || session_offsets != triangle_offsets || session_intervals != triangle_intervals )
+	{
+		std::cout << "Error: the session gives other results than the whole triangle! \n";
+		phat_session_destroy( session );
+		return 1;
+	}
+	
+	phat_session_load_csr( session, 8, col_ptr, row_idx, dims );
+	phat_session_reduce( session, 0 );
+	std::vector< std::int64_t > session_square_betti( 2, 777 ), csr_square_betti( 2, 777 );
+	std::vector< std::int64_t > session_square_intervals( 8, 777 ), session_square_offsets( 2*1+3, 777 );
+	std::vector< std::int64_t > csr_square_intervals( 8, 777 ), csr_square_offsets( 2*1+3, 777 );
+	phat_session_betti_numbers( session, 1, session_square_betti.data() );
+	session_length = phat_session_persistence_intervals_by_dimension( session, 1, 8, session_square_intervals.data(), session_square_offsets.data() );
+	compute_betti_numbers_csr( 8, 1, col_ptr, row_idx, dims, 0, csr_square_betti.data() );
+	std::int64_t csr_length = compute_persistence_intervals_by_dimension_csr( 8, 1, col_ptr, row_idx, dims, 0, 8, csr_square_intervals.data(), csr_square_offsets.data() );
+	bool is_session_correct = phat_session_number_of_cells( session ) == 8 && session_square_betti == csr_square_betti && session_length == csr_length
+	                          && session_square_offsets == csr_square_offsets && session_square_intervals == csr_square_intervals;
+	phat_session_destroy( session );
+	
+	std::cout << "Betti numbers of the square up to dimension 0 from a session : \n";
+	for ( size_t i = 0 ; i != session_square_betti.size() ; ++i )std::cout << session_square_betti[i] << " ";
+	std::cout << std::endl;
+	if ( !is_session_correct || session_square_betti[1] != -1 )
+	{
+		std::cout << "Error: the session gives other results for the square up to dimension 0! \n";
+		return 1;
+	}
+	
 	std::cout << "That's all folks! \n";
 												  
 	return 0;
@@ -17,6 +17,7 @@
     along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
 
 #include "../include/phat/compute_persistence_pairs.h"
+#include "../include/phat/streaming_reduction.h"
 
 #include "../include/phat/representations/vector_vector.h"
 #include "../include/phat/representations/vector_heap.h"
@@ -26,17 +27,23 @@
 #include "../include/phat/representations/heap_pivot_column.h"
 #include "../include/phat/representations/full_pivot_column.h"
 #include "../include/phat/representations/bit_tree_pivot_column.h"
+#include "../include/phat/representations/compressed_sparse_column.h"
+#include "../include/phat/representations/memory_mapped_column.h"
 
 #include "../include/phat/algorithms/twist_reduction.h"
 #include "../include/phat/algorithms/standard_reduction.h"
 #include "../include/phat/algorithms/row_reduction.h"
 #include "../include/phat/algorithms/chunk_reduction.h"
 #include "../include/phat/algorithms/spectral_sequence_reduction.h"
+#include "../include/phat/algorithms/parallel_twist_reduction.h"
+#include "../include/phat/algorithms/cohomology_reduction.h"
 
 #include "../include/phat/helpers/dualize.h"
+#include "../include/phat/helpers/apparent_pairs.h"
 
-enum Representation_type { VECTOR_VECTOR, VECTOR_HEAP, VECTOR_SET, SPARSE_PIVOT_COLUMN, FULL_PIVOT_COLUMN, BIT_TREE_PIVOT_COLUMN, VECTOR_LIST, HEAP_PIVOT_COLUMN };
-enum Algorithm_type  {STANDARD, TWIST, ROW, CHUNK, CHUNK_SEQUENTIAL, SPECTRAL_SEQUENCE };
+enum Representation_type { VECTOR_VECTOR, VECTOR_HEAP, VECTOR_SET, SPARSE_PIVOT_COLUMN, FULL_PIVOT_COLUMN, BIT_TREE_PIVOT_COLUMN, VECTOR_LIST, HEAP_PIVOT_COLUMN, COMPRESSED_SPARSE_COLUMN, MEMORY_MAPPED_COLUMN };
+enum Algorithm_type  {STANDARD, TWIST, ROW, CHUNK, CHUNK_SEQUENTIAL, SPECTRAL_SEQUENCE, PARALLEL_TWIST, COHOMOLOGY };
+enum File_format_type { BINARY, ASCII, COMPACT };
 
 void print_help() {
     std::cerr << "Usage: " << "phat " << "[options] input_filename output_filename" << std::endl;
@@ -45,11 +52,15 @@ void print_help() {
     std::cerr << std::endl;
     std::cerr << "--ascii   --  use ascii file format" << std::endl;
     std::cerr << "--binary  --  use binary file format (default)" << std::endl;
+    std::cerr << "--compact --  use compact binary file format" << std::endl;
     std::cerr << "--help    --  prints this screen" << std::endl;
     std::cerr << "--verbose --  verbose output" << std::endl;
     std::cerr << "--dualize   --  use dualization approach" << std::endl;
-    std::cerr << "--vector_vector, --vector_heap, --vector_set, --vector_list, --full_pivot_column, --sparse_pivot_column, --heap_pivot_column, --bit_tree_pivot_column  --  selects a representation data structure for boundary matrices (default is '--bit_tree_pivot_column')" << std::endl;
-    std::cerr << "--standard, --twist, --chunk, --chunk_sequential, --spectral_sequence, --row  --  selects a reduction algorithm (default is '--twist')" << std::endl;
+    std::cerr << "--apparent_pairs  --  find apparent pairs in parallel before the reduction, which skips them (only clears their birth columns for --parallel_twist, --spectral_sequence and --cohomology)" << std::endl;
+    std::cerr << "--stream  --  reduce the columns with the standard algorithm while the input file is being read (cannot be combined with a representation or algorithm option)" << std::endl;
+    std::cerr << "--spill   --  with --stream, keep at most 2^26 row indices in memory and spill the other reduced columns to output_filename.spill" << std::endl;
+    std::cerr << "--vector_vector, --vector_heap, --vector_set, --vector_list, --full_pivot_column, --sparse_pivot_column, --heap_pivot_column, --bit_tree_pivot_column, --compressed_sparse_column, --memory_mapped_column  --  selects a representation data structure for boundary matrices (default is '--bit_tree_pivot_column')" << std::endl;
+    std::cerr << "--standard, --twist, --parallel_twist, --chunk, --chunk_sequential, --spectral_sequence, --row, --cohomology  --  selects a reduction algorithm (default is '--twist')" << std::endl;
 }
 
 void print_help_and_exit() {
@@ -57,8 +68,9 @@ void print_help_and_exit() {
     exit( EXIT_FAILURE );
 }
 
-void parse_command_line( int argc, char** argv, bool& use_binary, Representation_type& representation, Algorithm_type& algorithm,
-                         std::string& input_filename, std::string& output_filename, bool& verbose, bool& dualize) {
+void parse_command_line( int argc, char** argv, File_format_type& file_format, Representation_type& representation, Algorithm_type& algorithm,
+                         std::string& input_filename, std::string& output_filename, bool& verbose, bool& dualize, bool& apparent_pairs, bool& stream, bool& spill,
+                         bool& reduction_selected ) {
 
     if( argc < 3 ) print_help_and_exit();
 
@@ -68,23 +80,31 @@ void parse_command_line( int argc, char** argv, bool& use_binary, Representation
     for( int idx = 1; idx < argc - 2; idx++ ) {
         const std::string option = argv[ idx ];
 
-        if( option == "--ascii" ) use_binary = false;
-        else if( option == "--binary" ) use_binary = true;
+        if( option == "--ascii" ) file_format = ASCII;
+        else if( option == "--binary" ) file_format = BINARY;
+        else if( option == "--compact" ) file_format = COMPACT;
         else if( option == "--dualize" ) dualize = true;
-        else if( option == "--vector_vector" ) representation = VECTOR_VECTOR;
-        else if( option == "--vector_heap" ) representation = VECTOR_HEAP;
-        else if( option == "--vector_set" ) representation = VECTOR_SET;
-        else if( option == "--vector_list" ) representation = VECTOR_LIST;
-        else if( option == "--full_pivot_column" )  representation = FULL_PIVOT_COLUMN;
-        else if( option == "--bit_tree_pivot_column" )  representation = BIT_TREE_PIVOT_COLUMN;
-        else if( option == "--sparse_pivot_column" ) representation = SPARSE_PIVOT_COLUMN;
-        else if( option == "--heap_pivot_column" ) representation = HEAP_PIVOT_COLUMN;
-        else if( option == "--standard" ) algorithm = STANDARD;
-        else if( option == "--twist" ) algorithm = TWIST;
-        else if( option == "--row" ) algorithm = ROW;
-        else if( option == "--chunk" ) algorithm = CHUNK;
-        else if( option == "--chunk_sequential" ) algorithm = CHUNK_SEQUENTIAL;
-        else if( option == "--spectral_sequence" ) algorithm = SPECTRAL_SEQUENCE;
+        else if( option == "--apparent_pairs" ) apparent_pairs = true;
+        else if( option == "--stream" ) stream = true;
+        else if( option == "--spill" ) spill = true;
+        else if( option == "--vector_vector" ) { representation = VECTOR_VECTOR; reduction_selected = true; }
+        else if( option == "--vector_heap" ) { representation = VECTOR_HEAP; reduction_selected = true; }
+        else if( option == "--vector_set" ) { representation = VECTOR_SET; reduction_selected = true; }
+        else if( option == "--vector_list" ) { representation = VECTOR_LIST; reduction_selected = true; }
+        else if( option == "--full_pivot_column" )  { representation = FULL_PIVOT_COLUMN; reduction_selected = true; }
+        else if( option == "--bit_tree_pivot_column" )  { representation = BIT_TREE_PIVOT_COLUMN; reduction_selected = true; }
+        else if( option == "--sparse_pivot_column" ) { representation = SPARSE_PIVOT_COLUMN; reduction_selected = true; }
+        else if( option == "--heap_pivot_column" ) { representation = HEAP_PIVOT_COLUMN; reduction_selected = true; }
+        else if( option == "--compressed_sparse_column" ) { representation = COMPRESSED_SPARSE_COLUMN; reduction_selected = true; }
+        else if( option == "--memory_mapped_column" ) { representation = MEMORY_MAPPED_COLUMN; reduction_selected = true; }
+        else if( option == "--standard" ) { algorithm = STANDARD; reduction_selected = true; }
+        else if( option == "--twist" ) { algorithm = TWIST; reduction_selected = true; }
+        else if( option == "--parallel_twist" ) { algorithm = PARALLEL_TWIST; reduction_selected = true; }
+        else if( option == "--cohomology" ) { algorithm = COHOMOLOGY; reduction_selected = true; }
+        else if( option == "--row" ) { algorithm = ROW; reduction_selected = true; }
+        else if( option == "--chunk" ) { algorithm = CHUNK; reduction_selected = true; }
+        else if( option == "--chunk_sequential" ) { algorithm = CHUNK_SEQUENTIAL; reduction_selected = true; }
+        else if( option == "--spectral_sequence" ) { algorithm = SPECTRAL_SEQUENCE; reduction_selected = true; }
         else if( option == "--verbose" ) verbose = true;
         else if( option == "--help" ) print_help_and_exit();
         else print_help_and_exit();
@@ -93,19 +113,40 @@ void parse_command_line( int argc, char** argv, bool& use_binary, Representation
 
 #define LOG(msg) if( verbose ) std::cout << msg << std::endl;
 
+// Number of columns of the boundary matrix in the given file, or -1 if the file cannot be read. An ascii file is
+// mapped and its lines are counted here, so 'ascii_input' is kept open to be parsed afterwards.
+phat::index get_num_cols_of_file( std::string filename, File_format_type file_format, phat::mapped_ascii_matrix& ascii_input ) {
+    if( file_format == COMPACT ) {
+        phat::mapped_compact_file input_file;
+        return input_file.open( filename, phat::COMPACT_BOUNDARY_MATRIX ) ? input_file.get_num_items() : -1;
+    } else if( file_format == BINARY ) {
+        std::ifstream input_stream( filename.c_str( ), std::ios_base::binary | std::ios_base::in );
+        int64_t nr_columns;
+        if( input_stream.fail( ) || !input_stream.read( (char*)&nr_columns, sizeof( int64_t ) ) )
+            return -1;
+        return (phat::index)nr_columns;
+    } else {
+        return ascii_input.open( filename ) ? ascii_input.get_num_cols() : -1;
+    }
+}
+
 template<typename Representation, typename Algorithm>
-void compute_pairing( std::string input_filename, std::string output_filename, bool use_binary, bool verbose, bool dualize ) {
+void compute_pairing( std::string input_filename, std::string output_filename, File_format_type file_format, bool verbose, bool dualize, bool apparent_pairs,
+                      const phat::mapped_ascii_matrix& ascii_input ) {
 
     phat::boundary_matrix< Representation > matrix;
     bool read_successful;
 
     double read_timer = omp_get_wtime();
-    if( use_binary ) {
+    if( file_format == COMPACT ) {
+        LOG( "Reading input file " << input_filename << " in compact mode" )
+        read_successful = matrix.load_compact( input_filename );
+    } else if( file_format == BINARY ) {
         LOG( "Reading input file " << input_filename << " in binary mode" )
         read_successful = matrix.load_binary( input_filename );
     } else {
         LOG( "Reading input file " << input_filename << " in ascii mode" )
-        read_successful = matrix.load_ascii( input_filename );
+        read_successful = ascii_input.get_num_chunks() > 0 && matrix.load_ascii( ascii_input );
     }
     double read_time = omp_get_wtime() - read_timer;
     double read_time_rounded = floor( read_time * 10.0 + 0.5 ) / 10.0;
@@ -130,7 +171,12 @@ void compute_pairing( std::string input_filename, std::string output_filename, b
     double pairs_timer = omp_get_wtime();
     phat::persistence_pairs pairs;
     LOG( "Computing persistence pairs ..." )
-    phat::compute_persistence_pairs < Algorithm > ( pairs, matrix );
+    if( apparent_pairs ) {
+        phat::index nr_apparent_pairs = phat::compute_persistence_pairs_with_apparent_pairs< Algorithm >( pairs, matrix );
+        LOG( "Found " << nr_apparent_pairs << " apparent pairs" )
+    } else {
+        phat::compute_persistence_pairs < Algorithm > ( pairs, matrix );
+    }
     double pairs_time = omp_get_wtime() - pairs_timer;
     double pairs_time_rounded = floor( pairs_time * 10.0 + 0.5 ) / 10.0;
     LOG( "Computing persistence pairs took " << std::setiosflags( std::ios::fixed ) << std::setiosflags( std::ios::showpoint ) << std::setprecision( 1 ) << pairs_time_rounded <<"s" )
@@ -139,7 +185,10 @@ void compute_pairing( std::string input_filename, std::string output_filename, b
     
 
     double write_timer = omp_get_wtime();
-    if( use_binary ) {
+    if( file_format == COMPACT ) {
+        LOG( "Writing output file " << output_filename << " in compact mode ..." )
+        pairs.save_compact( output_filename );
+    } else if( file_format == BINARY ) {
         LOG( "Writing output file " << output_filename << " in binary mode ..." )
         pairs.save_binary( output_filename );
     } else {
@@ -151,31 +200,110 @@ void compute_pairing( std::string input_filename, std::string output_filename, b
     LOG( "Writing output file took " << std::setiosflags( std::ios::fixed ) << std::setiosflags( std::ios::showpoint ) << std::setprecision( 1 ) << write_time_rounded <<"s" )
 }
 
-#define COMPUTE_PAIRING(Representation) \
+// the boundary matrix is never held in memory as a whole -- reduced columns are kept, and spilled to disk if requested
+void compute_pairing_streaming( std::string input_filename, std::string output_filename, File_format_type file_format, bool verbose, bool spill ) {
+    const phat::index memory_budget = spill ? ( phat::index )1 << 26 : -1;
+    phat::streaming_reduction reduction( memory_budget, output_filename + ".spill" );
+
+    double stream_timer = omp_get_wtime();
+    bool read_successful;
+    if( file_format == BINARY ) {
+        LOG( "Reading and reducing input file " << input_filename << " in binary mode" )
+        phat::binary_column_reader reader;
+        read_successful = reader.open( input_filename ) && reduction.push_columns( reader );
+    } else if( file_format == ASCII ) {
+        LOG( "Reading and reducing input file " << input_filename << " in ascii mode" )
+        phat::ascii_column_reader reader;
+        read_successful = reader.open( input_filename ) && reduction.push_columns( reader );
+    } else {
+        std::cerr << "Streaming is only supported for the binary and ascii file formats" << std::endl;
+        print_help_and_exit();
+    }
+    double stream_time = omp_get_wtime() - stream_timer;
+    double stream_time_rounded = floor( stream_time * 10.0 + 0.5 ) / 10.0;
+    LOG( "Reading and reducing input file took " << std::setiosflags( std::ios::fixed ) << std::setiosflags( std::ios::showpoint ) << std::setprecision( 1 ) << stream_time_rounded <<"s" )
+    LOG( "Spilled " << reduction.get_column_store().get_num_spilled_bytes() << " bytes to disk" )
+
+    if( reduction.get_column_store().spill_failed() ) {
+        std::cerr << "Error writing spill file " << output_filename << ".spill" << std::endl;
+        exit( EXIT_FAILURE );
+    }
+    if( !read_successful ) {
+        std::cerr << "Error opening file " << input_filename << std::endl;
+        print_help_and_exit();
+    }
+
+    phat::persistence_pairs pairs = reduction.get_persistence_pairs();
+    double write_timer = omp_get_wtime();
+    if( file_format == BINARY ) {
+        LOG( "Writing output file " << output_filename << " in binary mode ..." )
+        pairs.save_binary( output_filename );
+    } else {
+        LOG( "Writing output file " << output_filename << " in ascii mode ..." )
+        pairs.save_ascii( output_filename );
+    }
+    double write_time = omp_get_wtime() - write_timer;
+    double write_time_rounded = floor( write_time * 10.0 + 0.5 ) / 10.0;
+    LOG( "Writing output file took " << std::setiosflags( std::ios::fixed ) << std::setiosflags( std::ios::showpoint ) << std::setprecision( 1 ) << write_time_rounded <<"s" )
+}
+
+#define COMPUTE_PAIRING_WITH_INDEX(Representation) \
     switch( algorithm ) { \
-    case STANDARD: compute_pairing< phat::Representation, phat::standard_reduction> ( input_filename, output_filename, use_binary, verbose, dualize ); break; \
-    case TWIST: compute_pairing< phat::Representation, phat::twist_reduction> ( input_filename, output_filename, use_binary, verbose, dualize ); break; \
-    case ROW: compute_pairing< phat::Representation, phat::row_reduction >( input_filename, output_filename, use_binary, verbose, dualize ); break; \
-    case SPECTRAL_SEQUENCE: compute_pairing< phat::Representation, phat::spectral_sequence_reduction >( input_filename, output_filename, use_binary, verbose, dualize ); break; \
-    case CHUNK: compute_pairing< phat::Representation, phat::chunk_reduction >( input_filename, output_filename, use_binary, verbose, dualize ); break; \
+    case STANDARD: compute_pairing< phat::Representation, phat::standard_reduction> ( input_filename, output_filename, file_format, verbose, dualize, apparent_pairs, ascii_input ); break; \
+    case TWIST: compute_pairing< phat::Representation, phat::twist_reduction> ( input_filename, output_filename, file_format, verbose, dualize, apparent_pairs, ascii_input ); break; \
+    case PARALLEL_TWIST: compute_pairing< phat::Representation, phat::parallel_twist_reduction> ( input_filename, output_filename, file_format, verbose, dualize, apparent_pairs, ascii_input ); break; \
+    case COHOMOLOGY: compute_pairing< phat::Representation, phat::cohomology_reduction> ( input_filename, output_filename, file_format, verbose, dualize, apparent_pairs, ascii_input ); break; \
+    case ROW: compute_pairing< phat::Representation, phat::row_reduction >( input_filename, output_filename, file_format, verbose, dualize, apparent_pairs, ascii_input ); break; \
+    case SPECTRAL_SEQUENCE: compute_pairing< phat::Representation, phat::spectral_sequence_reduction >( input_filename, output_filename, file_format, verbose, dualize, apparent_pairs, ascii_input ); break; \
+    case CHUNK: compute_pairing< phat::Representation, phat::chunk_reduction >( input_filename, output_filename, file_format, verbose, dualize, apparent_pairs, ascii_input ); break; \
     case CHUNK_SEQUENTIAL: int num_threads = omp_get_max_threads(); \
                            omp_set_num_threads( 1 ); \
-                           compute_pairing< phat::Representation, phat::chunk_reduction >( input_filename, output_filename, use_binary, verbose, dualize ); break; \
+                           compute_pairing< phat::Representation, phat::chunk_reduction >( input_filename, output_filename, file_format, verbose, dualize, apparent_pairs, ascii_input ); break; \
                            omp_set_num_threads( num_threads ); \
                            break; \
     }
 
+// use 32-bit row indices whenever all of them fit
+#define COMPUTE_PAIRING(Representation) \
+    if( use_32_bit_indices ) { \
+        LOG( "Using 32-bit indices" ) \
+        COMPUTE_PAIRING_WITH_INDEX(Representation##_32) \
+    } else { \
+        COMPUTE_PAIRING_WITH_INDEX(Representation) \
+    }
+
 int main( int argc, char** argv )
 {
-    bool use_binary = true; // interpret input as binary or ascii file
+    File_format_type file_format = BINARY; // interpret input as binary, ascii or compact file
     Representation_type representation = BIT_TREE_PIVOT_COLUMN; // representation class
     Algorithm_type algorithm = TWIST; // reduction algorithm
     std::string input_filename; // name of file that contains the boundary matrix
     std::string output_filename; // name of file that will contain the persistence pairs
     bool verbose = false; // print timings / info
     bool dualize = false; // toggle for dualization approach
+    bool apparent_pairs = false; // toggle for the apparent pairs pre-pass
+    bool stream = false; // reduce while reading, without loading the whole boundary matrix
+    bool spill = false; // spill reduced columns to disk when streaming
+    bool reduction_selected = false; // a representation or algorithm was given explicitly
+
+    parse_command_line( argc, argv, file_format, representation, algorithm, input_filename, output_filename, verbose, dualize, apparent_pairs, stream, spill, reduction_selected );
+
+    if( stream ) {
+        if( dualize ) {
+            std::cerr << "--stream cannot be combined with --dualize" << std::endl;
+            print_help_and_exit();
+        }
+        if( reduction_selected ) {
+            std::cerr << "--stream always uses the standard algorithm on its own column store and cannot be combined with a representation or algorithm option" << std::endl;
+            print_help_and_exit();
+        }
+        compute_pairing_streaming( input_filename, output_filename, file_format, verbose, spill );
+        return 0;
+    }
 
-    parse_command_line( argc, argv, use_binary, representation, algorithm, input_filename, output_filename, verbose, dualize );
+    phat::mapped_ascii_matrix ascii_input;
+    const phat::index num_cols = get_num_cols_of_file( input_filename, file_format, ascii_input );
+    const bool use_32_bit_indices = num_cols >= 0 && num_cols <= std::numeric_limits< int32_t >::max();
 
     switch( representation ) {
     case VECTOR_VECTOR: COMPUTE_PAIRING(vector_vector) break;
@@ -186,5 +314,7 @@ int main( int argc, char** argv )
     case BIT_TREE_PIVOT_COLUMN: COMPUTE_PAIRING(bit_tree_pivot_column) break;
     case SPARSE_PIVOT_COLUMN: COMPUTE_PAIRING(sparse_pivot_column) break;
     case HEAP_PIVOT_COLUMN: COMPUTE_PAIRING(heap_pivot_column) break;
+    case COMPRESSED_SPARSE_COLUMN: COMPUTE_PAIRING(compressed_sparse_column) break;
+    case MEMORY_MAPPED_COLUMN: COMPUTE_PAIRING_WITH_INDEX(memory_mapped_column) break; // stores the int64 entries of the file
     }
 }
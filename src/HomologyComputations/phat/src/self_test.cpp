@@ -17,6 +17,10 @@
     along with PHAT.  If not, see <http://www.gnu.org/licenses/>. */
 
 #include "../include/phat/compute_persistence_pairs.h"
+#include "../include/phat/streaming_reduction.h"
+#include "../include/phat/incremental_reduction.h"
+#include "../include/phat/vineyard.h"
+#include "../include/phat/reduced_basis.h"
 
 #include "../include/phat/representations/vector_vector.h"
 #include "../include/phat/representations/vector_heap.h"
@@ -26,12 +30,18 @@
 #include "../include/phat/representations/heap_pivot_column.h"
 #include "../include/phat/representations/full_pivot_column.h"
 #include "../include/phat/representations/bit_tree_pivot_column.h"
+#include "../include/phat/representations/compressed_sparse_column.h"
+#include "../include/phat/representations/memory_mapped_column.h"
 
 #include "../include/phat/algorithms/twist_reduction.h"
 #include "../include/phat/algorithms/standard_reduction.h"
 #include "../include/phat/algorithms/row_reduction.h"
 #include "../include/phat/algorithms/chunk_reduction.h"
 #include "../include/phat/algorithms/spectral_sequence_reduction.h"
+#include "../include/phat/algorithms/parallel_twist_reduction.h"
+#include "../include/phat/algorithms/cohomology_reduction.h"
+
+#include "../include/phat/helpers/apparent_pairs.h"
 
 int main( int argc, char** argv )
 {
@@ -45,6 +55,11 @@ int main( int argc, char** argv )
     typedef phat::vector_heap Vec_heap;
     typedef phat::vector_set Vec_set;
     typedef phat::vector_list Vec_list;
+    typedef phat::compressed_sparse_column CSC;
+    typedef phat::bit_tree_pivot_column_32 BitTree_32;
+    typedef phat::vector_vector_32 Vec_vec_32;
+    typedef phat::compressed_sparse_column_32 CSC_32;
+    typedef phat::memory_mapped_column Mapped;
 
     std::cout << "Reading test data " << test_data << " in binary format ..." << std::endl;
     phat::boundary_matrix< Full > boundary_matrix;
@@ -96,6 +111,11 @@ int main( int argc, char** argv )
         phat::boundary_matrix< Vec_list > vec_list_boundary_matrix = boundary_matrix;
         phat::compute_persistence_pairs< phat::chunk_reduction >( vec_list_pairs, vec_list_boundary_matrix );
 
+        std::cout << "Running Chunk - CSC ..." << std::endl;
+        phat::persistence_pairs csc_pairs;
+        phat::boundary_matrix< CSC > csc_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::chunk_reduction >( csc_pairs, csc_boundary_matrix );
+
         if( sparse_pairs != heap_pairs ) {
             std::cerr << "Error: sparse and heap differ!" << std::endl;
             error = true;
@@ -128,6 +148,10 @@ int main( int argc, char** argv )
             std::cerr << "Error: vec_list and sparse differ!" << std::endl;
             error = true;
         }
+        if( sparse_pairs != csc_pairs ) {
+            std::cerr << "Error: sparse and csc differ!" << std::endl;
+            error = true;
+        }
 
         if( error ) return EXIT_FAILURE;
         else std::cout << "All results are identical (as they should be)" << std::endl;
@@ -140,6 +164,11 @@ int main( int argc, char** argv )
         phat::boundary_matrix< BitTree > twist_boundary_matrix = boundary_matrix;
         phat::compute_persistence_pairs< phat::twist_reduction >( twist_pairs, twist_boundary_matrix );
 
+        std::cout << "Running Parallel twist - BitTree ..." << std::endl;
+        phat::persistence_pairs parallel_twist_pairs;
+        phat::boundary_matrix< BitTree > parallel_twist_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::parallel_twist_reduction >( parallel_twist_pairs, parallel_twist_boundary_matrix );
+
         std::cout << "Running Standard - BitTree ..." << std::endl;
         phat::persistence_pairs std_pairs;
         phat::boundary_matrix< BitTree > std_boundary_matrix = boundary_matrix;
@@ -160,6 +189,51 @@ int main( int argc, char** argv )
         phat::boundary_matrix< BitTree > ss_boundary_matrix = boundary_matrix;
         phat::compute_persistence_pairs< phat::spectral_sequence_reduction >( ss_pairs, ss_boundary_matrix );
 
+        std::cout << "Running Cohomology - BitTree ..." << std::endl;
+        phat::persistence_pairs cohomology_pairs;
+        phat::boundary_matrix< BitTree > cohomology_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::cohomology_reduction >( cohomology_pairs, cohomology_boundary_matrix );
+
+        std::cout << "Running Standard, Twist, Row, Chunk and Cohomology with apparent pairs - BitTree ..." << std::endl;
+        phat::persistence_pairs apparent_pairs_of[ 5 ];
+        for( int algorithm = 0; algorithm < 5; algorithm++ ) {
+            phat::boundary_matrix< BitTree > apparent_boundary_matrix = boundary_matrix;
+            switch( algorithm ) {
+            case 0: phat::compute_persistence_pairs_with_apparent_pairs< phat::standard_reduction >( apparent_pairs_of[ algorithm ], apparent_boundary_matrix ); break;
+            case 1: phat::compute_persistence_pairs_with_apparent_pairs< phat::twist_reduction >( apparent_pairs_of[ algorithm ], apparent_boundary_matrix ); break;
+            case 2: phat::compute_persistence_pairs_with_apparent_pairs< phat::row_reduction >( apparent_pairs_of[ algorithm ], apparent_boundary_matrix ); break;
+            case 3: phat::compute_persistence_pairs_with_apparent_pairs< phat::chunk_reduction >( apparent_pairs_of[ algorithm ], apparent_boundary_matrix ); break;
+            case 4: phat::compute_persistence_pairs_with_apparent_pairs< phat::cohomology_reduction >( apparent_pairs_of[ algorithm ], apparent_boundary_matrix ); break;
+            }
+        }
+        std::vector< phat::index > apparent_births;
+        phat::boundary_matrix< BitTree > apparent_boundary_matrix = boundary_matrix;
+        phat::find_apparent_pairs( apparent_boundary_matrix, apparent_births );
+
+        if( twist_pairs != cohomology_pairs ) {
+            std::cerr << "Error: twist and cohomology differ!" << std::endl;
+            error = true;
+        }
+        for( int algorithm = 0; algorithm < 5; algorithm++ ) {
+            if( twist_pairs != apparent_pairs_of[ algorithm ] ) {
+                std::cerr << "Error: twist and reduction with apparent pairs differ!" << std::endl;
+                error = true;
+            }
+        }
+        std::vector< phat::index > twist_births( apparent_births.size(), -1 );
+        for( phat::index idx = 0; idx < twist_pairs.get_num_pairs(); idx++ )
+            twist_births[ twist_pairs.get_pair( idx ).second ] = twist_pairs.get_pair( idx ).first;
+        for( phat::index cur_col = 0; cur_col < (phat::index)apparent_births.size(); cur_col++ ) {
+            if( apparent_births[ cur_col ] != -1 && twist_births[ cur_col ] != apparent_births[ cur_col ] ) {
+                std::cerr << "Error: apparent pair not found by twist!" << std::endl;
+                error = true;
+                break;
+            }
+        }
+        if( twist_pairs != parallel_twist_pairs ) {
+            std::cerr << "Error: twist and parallel twist differ!" << std::endl;
+            error = true;
+        }
         if( twist_pairs != std_pairs ) {
             std::cerr << "Error: twist and standard differ!" << std::endl;
             error = true;
@@ -185,6 +259,495 @@ int main( int argc, char** argv )
         else std::cout << "All results are identical (as they should be)" << std::endl;
     }
 
+    std::cout << "Comparing algorithms using CSC representation ..." << std::endl;
+    {
+        std::cout << "Running Twist - CSC ..." << std::endl;
+        phat::persistence_pairs twist_pairs;
+        phat::boundary_matrix< CSC > twist_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::twist_reduction >( twist_pairs, twist_boundary_matrix );
+
+        std::cout << "Running Parallel twist - CSC ..." << std::endl;
+        phat::persistence_pairs parallel_twist_pairs;
+        phat::boundary_matrix< CSC > parallel_twist_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::parallel_twist_reduction >( parallel_twist_pairs, parallel_twist_boundary_matrix );
+
+        std::cout << "Running Standard - CSC ..." << std::endl;
+        phat::persistence_pairs std_pairs;
+        phat::boundary_matrix< CSC > std_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::standard_reduction >( std_pairs, std_boundary_matrix );
+
+        std::cout << "Running Row - CSC ..." << std::endl;
+        phat::persistence_pairs row_pairs;
+        phat::boundary_matrix< CSC > row_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::row_reduction >( row_pairs, row_boundary_matrix );
+
+        std::cout << "Running Spectral sequence - CSC ..." << std::endl;
+        phat::persistence_pairs ss_pairs;
+        phat::boundary_matrix< CSC > ss_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::spectral_sequence_reduction >( ss_pairs, ss_boundary_matrix );
+
+        if( twist_pairs != parallel_twist_pairs ) {
+            std::cerr << "Error: twist and parallel twist differ!" << std::endl;
+            error = true;
+        }
+        if( twist_pairs != std_pairs ) {
+            std::cerr << "Error: twist and standard differ!" << std::endl;
+            error = true;
+        }
+        if( std_pairs != row_pairs ) {
+            std::cerr << "Error: standard and row differ!" << std::endl;
+            error = true;
+        }
+        if( row_pairs != ss_pairs ) {
+            std::cerr << "Error: row and spectral sequence differ!" << std::endl;
+            error = true;
+        }
+
+        if( error ) return EXIT_FAILURE;
+        else std::cout << "All results are identical (as they should be)" << std::endl;
+    }
+
+    std::cout << "Comparing 64-bit and 32-bit indices using Twist algorithm ..." << std::endl;
+    {
+        std::cout << "Running Twist - BitTree ..." << std::endl;
+        phat::persistence_pairs bit_tree_pairs;
+        phat::boundary_matrix< BitTree > bit_tree_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::twist_reduction >( bit_tree_pairs, bit_tree_boundary_matrix );
+
+        std::cout << "Running Twist - BitTree_32 ..." << std::endl;
+        phat::persistence_pairs bit_tree_32_pairs;
+        phat::boundary_matrix< BitTree_32 > bit_tree_32_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::twist_reduction >( bit_tree_32_pairs, bit_tree_32_boundary_matrix );
+
+        std::cout << "Running Twist - Vec_vec_32 ..." << std::endl;
+        phat::persistence_pairs vec_vec_32_pairs;
+        phat::boundary_matrix< Vec_vec_32 > vec_vec_32_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::twist_reduction >( vec_vec_32_pairs, vec_vec_32_boundary_matrix );
+
+        std::cout << "Running Twist - CSC_32 ..." << std::endl;
+        phat::persistence_pairs csc_32_pairs;
+        phat::boundary_matrix< CSC_32 > csc_32_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::twist_reduction >( csc_32_pairs, csc_32_boundary_matrix );
+
+        if( bit_tree_pairs != bit_tree_32_pairs ) {
+            std::cerr << "Error: bit_tree and bit_tree_32 differ!" << std::endl;
+            error = true;
+        }
+        if( bit_tree_32_pairs != vec_vec_32_pairs ) {
+            std::cerr << "Error: bit_tree_32 and vec_vec_32 differ!" << std::endl;
+            error = true;
+        }
+        if( vec_vec_32_pairs != csc_32_pairs ) {
+            std::cerr << "Error: vec_vec_32 and csc_32 differ!" << std::endl;
+            error = true;
+        }
+        phat::boundary_matrix< Vec_vec_32 > vec_vec_32_copy = boundary_matrix;
+        if( vec_vec_32_copy != boundary_matrix ) {
+            std::cerr << "Error: 32-bit conversion bug" << std::endl;
+            error = true;
+        }
+
+        if( error ) return EXIT_FAILURE;
+        else std::cout << "All results are identical (as they should be)" << std::endl;
+    }
+
+    std::cout << "Comparing memory mapped and copied input using Twist algorithm ..." << std::endl;
+    {
+        std::cout << "Running Twist - BitTree ..." << std::endl;
+        phat::persistence_pairs bit_tree_pairs;
+        phat::boundary_matrix< BitTree > bit_tree_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::twist_reduction >( bit_tree_pairs, bit_tree_boundary_matrix );
+
+        std::cout << "Running Twist - Mapped ..." << std::endl;
+        phat::persistence_pairs mapped_pairs;
+        phat::boundary_matrix< Mapped > mapped_boundary_matrix;
+        mapped_boundary_matrix.load_binary( test_data );
+        if( mapped_boundary_matrix != boundary_matrix ) {
+            std::cerr << "Error: memory mapped input differs!" << std::endl;
+            error = true;
+        }
+        phat::compute_persistence_pairs< phat::twist_reduction >( mapped_pairs, mapped_boundary_matrix );
+
+        if( bit_tree_pairs != mapped_pairs ) {
+            std::cerr << "Error: bit_tree and mapped differ!" << std::endl;
+            error = true;
+        }
+        phat::boundary_matrix< Mapped > reloaded_boundary_matrix;
+        reloaded_boundary_matrix.load_binary( test_data );
+        if( reloaded_boundary_matrix != boundary_matrix ) {
+            std::cerr << "Error: reduction of mapped matrix changed the input file!" << std::endl;
+            error = true;
+        }
+
+        if( error ) return EXIT_FAILURE;
+        else std::cout << "All results are identical (as they should be)" << std::endl;
+    }
+
+    std::cout << "Comparing ascii and binary input ..." << std::endl;
+    {
+        const std::string ascii_filename = "phat_self_test.dat";
+        phat::boundary_matrix< Vec_vec > ascii_boundary_matrix;
+        if( !boundary_matrix.save_ascii( ascii_filename ) || !ascii_boundary_matrix.load_ascii( ascii_filename ) || ascii_boundary_matrix != boundary_matrix ) {
+            std::cerr << "Error: ascii input differs!" << std::endl;
+            error = true;
+        }
+
+        // comments, blank lines, trailing blanks, carriage returns and unsorted columns
+        std::ofstream( ascii_filename.c_str() ) << "# comment\n0\n\n  0 \r\n0\t\n1 1 0   \r\n  # indented comment\n2 4 3 5";
+        phat::boundary_matrix< Vec_vec > expected_boundary_matrix;
+        expected_boundary_matrix.set_num_cols( 5 );
+        const phat::index expected_rows[] = { 0, 1, 3, 4, 5 };
+        for( phat::index cur_col = 0; cur_col < 5; cur_col++ )
+            expected_boundary_matrix.set_dim( cur_col, cur_col < 3 ? 0 : (phat::dimension)( cur_col - 2 ) );
+        expected_boundary_matrix.set_col( 3, phat::column( expected_rows, expected_rows + 2 ) );
+        expected_boundary_matrix.set_col( 4, phat::column( expected_rows + 2, expected_rows + 5 ) );
+        if( !ascii_boundary_matrix.load_ascii( ascii_filename ) || ascii_boundary_matrix != expected_boundary_matrix ) {
+            std::cerr << "Error: ascii input with comments and unsorted columns differs!" << std::endl;
+            error = true;
+        }
+
+        std::ofstream( ascii_filename.c_str() ) << "0\n1 0 x\n";
+        if( ascii_boundary_matrix.load_ascii( ascii_filename ) ) {
+            std::cerr << "Error: malformed ascii input was accepted!" << std::endl;
+            error = true;
+        }
+        std::remove( ascii_filename.c_str() );
+
+        if( error ) return EXIT_FAILURE;
+        else std::cout << "All results are identical (as they should be)" << std::endl;
+    }
+
+    std::cout << "Comparing compact and binary format ..." << std::endl;
+    {
+        const std::string compact_filename = "phat_self_test.cpct";
+        phat::boundary_matrix< Vec_vec > compact_boundary_matrix;
+        if( !boundary_matrix.save_compact( compact_filename ) || !compact_boundary_matrix.load_compact( compact_filename )
+            || compact_boundary_matrix != boundary_matrix ) {
+            std::cerr << "Error: compact boundary matrix differs!" << std::endl;
+            error = true;
+        }
+
+        phat::persistence_pairs pairs;
+        phat::boundary_matrix< BitTree > bit_tree_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::twist_reduction >( pairs, bit_tree_boundary_matrix );
+        phat::persistence_pairs compact_pairs;
+        if( !pairs.save_compact( compact_filename ) || !compact_pairs.load_compact( compact_filename ) || compact_pairs != pairs ) {
+            std::cerr << "Error: compact persistence pairs differ!" << std::endl;
+            error = true;
+        }
+        if( compact_boundary_matrix.load_compact( compact_filename ) ) {
+            std::cerr << "Error: persistence pairs were loaded as a boundary matrix!" << std::endl;
+            error = true;
+        }
+        std::remove( compact_filename.c_str() );
+
+        if( error ) return EXIT_FAILURE;
+        else std::cout << "All results are identical (as they should be)" << std::endl;
+    }
+
+    std::cout << "Comparing streaming and in-memory reduction ..." << std::endl;
+    {
+        std::cout << "Running Twist - BitTree ..." << std::endl;
+        phat::persistence_pairs bit_tree_pairs;
+        phat::boundary_matrix< BitTree > bit_tree_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::twist_reduction >( bit_tree_pairs, bit_tree_boundary_matrix );
+
+        std::cout << "Running Streaming ..." << std::endl;
+        phat::streaming_reduction streaming;
+        phat::binary_column_reader reader;
+        if( !reader.open( test_data ) || !streaming.push_columns( reader, 1000 ) ) {
+            std::cerr << "Error: streaming input failed!" << std::endl;
+            error = true;
+        }
+        phat::persistence_pairs streaming_pairs = streaming.get_persistence_pairs();
+        if( bit_tree_pairs != streaming_pairs ) {
+            std::cerr << "Error: bit_tree and streaming differ!" << std::endl;
+            error = true;
+        }
+
+        std::cout << "Running Streaming - spilled ..." << std::endl;
+        phat::streaming_reduction spilled_streaming( 1000, "phat_self_test.spill" );
+        phat::column temp_col;
+        for( phat::index cur_col = 0; cur_col < boundary_matrix.get_num_cols(); cur_col++ ) {
+            boundary_matrix.get_col( cur_col, temp_col );
+            if( !spilled_streaming.push_column( boundary_matrix.get_dim( cur_col ), temp_col ) ) {
+                std::cerr << "Error: spill file could not be written or read!" << std::endl;
+                error = true;
+                break;
+            }
+        }
+        phat::persistence_pairs spilled_pairs = spilled_streaming.get_persistence_pairs();
+        if( bit_tree_pairs != spilled_pairs ) {
+            std::cerr << "Error: bit_tree and spilled streaming differ!" << std::endl;
+            error = true;
+        }
+
+        if( error ) return EXIT_FAILURE;
+        else std::cout << "All results are identical (as they should be)" << std::endl;
+    }
+
+    std::cout << "Comparing incremental and in-memory reduction ..." << std::endl;
+    {
+        std::cout << "Running Twist - BitTree ..." << std::endl;
+        phat::persistence_pairs bit_tree_pairs;
+        phat::boundary_matrix< BitTree > bit_tree_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::twist_reduction >( bit_tree_pairs, bit_tree_boundary_matrix );
+
+        std::cout << "Running Incremental - BitTree ..." << std::endl;
+        const phat::index nr_initial_columns = boundary_matrix.get_num_cols() / 2;
+        phat::incremental_reduction< BitTree > incremental;
+        incremental.get_boundary_matrix() = boundary_matrix;
+        incremental.get_boundary_matrix().set_num_cols( nr_initial_columns );
+        incremental.restart();
+        phat::persistence_pairs incremental_pairs;
+        incremental.reduce( incremental_pairs );
+        phat::column temp_col;
+        for( phat::index cur_col = nr_initial_columns; cur_col < boundary_matrix.get_num_cols(); cur_col++ ) {
+            boundary_matrix.get_col( cur_col, temp_col );
+            incremental.append_column( boundary_matrix.get_dim( cur_col ), temp_col );
+            if( cur_col % 1000 == 0 || cur_col + 1 == boundary_matrix.get_num_cols() ) {
+                const phat::index nr_reduced_columns = incremental.get_num_reduced_cols();
+                phat::persistence_pairs new_pairs;
+                incremental.reduce( new_pairs );
+                for( phat::index idx = 0; idx < new_pairs.get_num_pairs(); idx++ ) {
+                    if( new_pairs.get_pair( idx ).second < nr_reduced_columns ) {
+                        std::cerr << "Error: incremental reduction changed a pair of a reduced column!" << std::endl;
+                        error = true;
+                    }
+                    incremental_pairs.append_pair( new_pairs.get_pair( idx ).first, new_pairs.get_pair( idx ).second );
+                }
+            }
+        }
+        if( bit_tree_pairs != incremental_pairs ) {
+            std::cerr << "Error: bit_tree and incremental differ!" << std::endl;
+            error = true;
+        }
+
+        if( error ) return EXIT_FAILURE;
+        else std::cout << "All results are identical (as they should be)" << std::endl;
+    }
+
+    std::cout << "Testing transform matrix and representative cycles ..." << std::endl;
+    {
+        phat::persistence_pairs twist_pairs;
+        phat::boundary_matrix< BitTree > twist_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::twist_reduction >( twist_pairs, twist_boundary_matrix );
+
+        for( int algorithm = 0; algorithm < 2; algorithm++ ) {
+            std::cout << "Running " << ( algorithm == 0 ? "Twist" : "Standard" ) << " with transform matrix - BitTree ..." << std::endl;
+            phat::persistence_pairs tracked_pairs;
+            phat::boundary_matrix< BitTree > reduced_matrix = boundary_matrix;
+            phat::transform_matrix transform;
+            if( algorithm == 0 )
+                phat::compute_persistence_pairs< phat::twist_reduction >( tracked_pairs, reduced_matrix, transform );
+            else
+                phat::compute_persistence_pairs< phat::standard_reduction >( tracked_pairs, reduced_matrix, transform );
+            if( twist_pairs != tracked_pairs ) {
+                std::cerr << "Error: pairs with and without transform matrix differ!" << std::endl;
+                error = true;
+            }
+
+            // R = D V, and V is upper triangular with ones on the diagonal
+            phat::column transform_col, boundary_col, product_col, reduced_col;
+            for( phat::index cur_col = 0; cur_col < boundary_matrix.get_num_cols() && !error; cur_col++ ) {
+                transform.get_col( cur_col, transform_col );
+                if( transform_col.empty() || transform_col.back() != cur_col ) {
+                    std::cerr << "Error: transform matrix is not upper triangular!" << std::endl;
+                    error = true;
+                }
+                product_col.clear();
+                for( phat::index idx = 0; idx < (phat::index)transform_col.size(); idx++ ) {
+                    boundary_matrix.get_col( transform_col[ idx ], boundary_col );
+                    phat::column sum_col( product_col.size() + boundary_col.size() );
+                    sum_col.resize( std::set_symmetric_difference( product_col.begin(), product_col.end(), boundary_col.begin(), boundary_col.end(), sum_col.begin() ) - sum_col.begin() );
+                    product_col.swap( sum_col );
+                }
+                reduced_matrix.get_col( cur_col, reduced_col );
+                if( product_col != reduced_col ) {
+                    std::cerr << "Error: reduced matrix differs from boundary matrix times transform matrix!" << std::endl;
+                    error = true;
+                }
+            }
+
+            // essential classes are represented by a cycle of V that ends in their birth
+            phat::column cycle;
+            std::vector< bool > is_paired( boundary_matrix.get_num_cols(), false );
+            for( phat::index idx = 0; idx < tracked_pairs.get_num_pairs(); idx++ ) {
+                is_paired[ tracked_pairs.get_pair( idx ).first ] = is_paired[ tracked_pairs.get_pair( idx ).second ] = true;
+                phat::get_representative_cycle( reduced_matrix, transform, tracked_pairs.get_pair( idx ).first, tracked_pairs.get_pair( idx ).second, cycle );
+                if( cycle.empty() || cycle.back() != tracked_pairs.get_pair( idx ).first ) {
+                    std::cerr << "Error: wrong representative cycle of a finite class!" << std::endl;
+                    error = true;
+                }
+            }
+            for( phat::index birth = 0; birth < boundary_matrix.get_num_cols(); birth++ ) {
+                if( is_paired[ birth ] )
+                    continue;
+                phat::get_representative_cycle( reduced_matrix, transform, birth, -1, cycle );
+                if( cycle.empty() || cycle.back() != birth || !reduced_matrix.is_empty( birth ) ) {
+                    std::cerr << "Error: wrong representative cycle of an essential class!" << std::endl;
+                    error = true;
+                }
+            }
+        }
+
+        if( error ) return EXIT_FAILURE;
+        else std::cout << "All results are identical (as they should be)" << std::endl;
+    }
+
+    std::cout << "Comparing exhaustively reduced bases ..." << std::endl;
+    {
+        phat::reduced_basis bases[ 2 ];
+        for( int algorithm = 0; algorithm < 2; algorithm++ ) {
+            std::cout << "Running " << ( algorithm == 0 ? "Twist" : "Standard" ) << " with exhaustive reduction - BitTree ..." << std::endl;
+            phat::persistence_pairs pairs;
+            phat::boundary_matrix< BitTree > reduced_matrix = boundary_matrix;
+            phat::transform_matrix transform;
+            if( algorithm == 0 )
+                phat::compute_persistence_pairs< phat::twist_reduction >( pairs, reduced_matrix, transform );
+            else
+                phat::compute_persistence_pairs< phat::standard_reduction >( pairs, reduced_matrix, transform );
+            phat::reduced_basis& basis = bases[ algorithm ];
+            basis.init( reduced_matrix, &transform );
+
+            // every stored column is a cycle that ends in its lowest one and has no other row that is an earlier pivot
+            phat::column cycle, boundary_col, boundary_sum;
+            for( phat::index cur_col = 0; cur_col < basis.get_num_cols() && !error; cur_col++ ) {
+                basis.get_col( cur_col, cycle );
+                const phat::index lowest_one = reduced_matrix.is_empty( cur_col ) ? cur_col : reduced_matrix.get_max_index( cur_col );
+                if( cycle.empty() ) {
+                    if( !reduced_matrix.is_empty( cur_col ) || basis.get_death( cur_col ) == -1 ) {
+                        std::cerr << "Error: missing column in the reduced basis!" << std::endl;
+                        error = true;
+                    }
+                    continue;
+                }
+                if( cycle.back() != lowest_one ) {
+                    std::cerr << "Error: wrong lowest one in the reduced basis!" << std::endl;
+                    error = true;
+                }
+                boundary_sum.clear();
+                for( phat::index idx = 0; idx < (phat::index)cycle.size(); idx++ ) {
+                    if( idx + 1 < (phat::index)cycle.size() && basis.get_death( cycle[ idx ] ) != -1 && basis.get_death( cycle[ idx ] ) < cur_col ) {
+                        std::cerr << "Error: column of the reduced basis is not exhaustively reduced!" << std::endl;
+                        error = true;
+                    }
+                    boundary_matrix.get_col( cycle[ idx ], boundary_col );
+                    phat::column sum_col( boundary_sum.size() + boundary_col.size() );
+                    sum_col.resize( std::set_symmetric_difference( boundary_sum.begin(), boundary_sum.end(), boundary_col.begin(), boundary_col.end(), sum_col.begin() ) - sum_col.begin() );
+                    boundary_sum.swap( sum_col );
+                }
+                if( !boundary_sum.empty() ) {
+                    std::cerr << "Error: column of the reduced basis is not a cycle!" << std::endl;
+                    error = true;
+                }
+            }
+            for( phat::index idx = 0; idx < pairs.get_num_pairs() && !error; idx++ ) {
+                if( !basis.get_representative_cycle( pairs.get_pair( idx ).first, cycle ) || cycle.back() != pairs.get_pair( idx ).first ) {
+                    std::cerr << "Error: wrong representative cycle in the reduced basis!" << std::endl;
+                    error = true;
+                }
+            }
+        }
+
+        // the exhaustively reduced columns of the deaths do not depend on the algorithm
+        phat::column twist_col, standard_col;
+        for( phat::index cur_col = 0; cur_col < bases[ 0 ].get_num_cols() && !error; cur_col++ ) {
+            bases[ 0 ].get_col( cur_col, twist_col );
+            bases[ 1 ].get_col( cur_col, standard_col );
+            if( !twist_col.empty() && twist_col.back() != cur_col && twist_col != standard_col ) {
+                std::cerr << "Error: exhaustively reduced columns of Twist and Standard differ!" << std::endl;
+                error = true;
+            }
+        }
+
+        if( error ) return EXIT_FAILURE;
+        else std::cout << "All results are identical (as they should be)" << std::endl;
+    }
+
+    std::cout << "Comparing vineyard updates and reduction from scratch ..." << std::endl;
+    {
+        std::cout << "Running Vineyard ..." << std::endl;
+        phat::boundary_matrix< Vec_vec > permuted_boundary_matrix = boundary_matrix;
+        phat::vineyard vineyard;
+        vineyard.init( permuted_boundary_matrix );
+        const phat::index nr_columns = permuted_boundary_matrix.get_num_cols();
+        phat::column first_col, second_col, temp_col;
+        for( phat::index step = 0; step < 200 && nr_columns > 1; step++ ) {
+            // swaps two adjacent cells of the filtration, unless the first one is a face of the second one
+            const phat::index pos = ( step * 7919 ) % ( nr_columns - 1 );
+            permuted_boundary_matrix.get_col( pos, first_col );
+            permuted_boundary_matrix.get_col( pos + 1, second_col );
+            if( std::binary_search( second_col.begin(), second_col.end(), pos ) )
+                continue;
+            vineyard.transpose( pos );
+
+            const phat::dimension first_dim = permuted_boundary_matrix.get_dim( pos );
+            permuted_boundary_matrix.set_dim( pos, permuted_boundary_matrix.get_dim( pos + 1 ) );
+            permuted_boundary_matrix.set_dim( pos + 1, first_dim );
+            permuted_boundary_matrix.set_col( pos, second_col );
+            permuted_boundary_matrix.set_col( pos + 1, first_col );
+            for( phat::index cur_col = pos + 2; cur_col < nr_columns; cur_col++ ) {
+                permuted_boundary_matrix.get_col( cur_col, temp_col );
+                for( phat::index idx = 0; idx < (phat::index)temp_col.size(); idx++ )
+                    if( temp_col[ idx ] == pos || temp_col[ idx ] == pos + 1 )
+                        temp_col[ idx ] = 2 * pos + 1 - temp_col[ idx ];
+                std::sort( temp_col.begin(), temp_col.end() );
+                permuted_boundary_matrix.set_col( cur_col, temp_col );
+            }
+
+            if( step % 20 == 0 ) {
+                phat::persistence_pairs twist_pairs, vineyard_pairs;
+                phat::boundary_matrix< Vec_vec > twist_boundary_matrix = permuted_boundary_matrix;
+                phat::compute_persistence_pairs< phat::twist_reduction >( twist_pairs, twist_boundary_matrix );
+                vineyard.get_persistence_pairs( vineyard_pairs );
+                if( twist_pairs != vineyard_pairs ) {
+                    std::cerr << "Error: vineyard and twist differ after " << step << " transpositions!" << std::endl;
+                    error = true;
+                    break;
+                }
+            }
+        }
+
+        if( error ) return EXIT_FAILURE;
+        else std::cout << "All results are identical (as they should be)" << std::endl;
+    }
+
+    std::cout << "Comparing full and dimension-bounded reduction ..." << std::endl;
+    {
+        phat::persistence_pairs twist_pairs;
+        phat::boundary_matrix< BitTree > twist_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::twist_reduction >( twist_pairs, twist_boundary_matrix );
+
+        for( phat::dimension max_homology_dim = 0; max_homology_dim < boundary_matrix.get_max_dim(); max_homology_dim++ ) {
+            std::cout << "Running Twist and Chunk up to dimension " << (int)max_homology_dim << " - BitTree ..." << std::endl;
+            phat::persistence_pairs expected_pairs;
+            for( phat::index idx = 0; idx < twist_pairs.get_num_pairs(); idx++ )
+                if( boundary_matrix.get_dim( twist_pairs.get_pair( idx ).first ) <= max_homology_dim )
+                    expected_pairs.append_pair( twist_pairs.get_pair( idx ).first, twist_pairs.get_pair( idx ).second );
+
+            phat::persistence_pairs bounded_twist_pairs;
+            phat::boundary_matrix< BitTree > bounded_twist_boundary_matrix = boundary_matrix;
+            phat::compute_persistence_pairs< phat::twist_reduction >( bounded_twist_pairs, bounded_twist_boundary_matrix, max_homology_dim );
+
+            phat::persistence_pairs bounded_chunk_pairs;
+            phat::boundary_matrix< BitTree > bounded_chunk_boundary_matrix = boundary_matrix;
+            phat::compute_persistence_pairs< phat::chunk_reduction >( bounded_chunk_pairs, bounded_chunk_boundary_matrix, max_homology_dim );
+
+            if( expected_pairs != bounded_twist_pairs ) {
+                std::cerr << "Error: twist and dimension-bounded twist differ!" << std::endl;
+                error = true;
+            }
+            if( expected_pairs != bounded_chunk_pairs ) {
+                std::cerr << "Error: twist and dimension-bounded chunk differ!" << std::endl;
+                error = true;
+            }
+        }
+
+        if( error ) return EXIT_FAILURE;
+        else std::cout << "All results are identical (as they should be)" << std::endl;
+    }
+
     std::cout << "Comparing primal and dual approach using Chunk - Full ..." << std::endl;
     {
         phat::persistence_pairs primal_pairs;
@@ -195,10 +758,57 @@ int main( int argc, char** argv )
         phat::boundary_matrix< Full > dual_boundary_matrix = boundary_matrix;
         phat::compute_persistence_pairs_dualized< phat::chunk_reduction >( dual_pairs, dual_boundary_matrix );
 
+        phat::persistence_pairs cohomology_pairs;
+        phat::boundary_matrix< Full > cohomology_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::cohomology_reduction >( cohomology_pairs, cohomology_boundary_matrix );
+
         if( primal_pairs != dual_pairs ) {
             std::cerr << "Error: primal and dual differ!" << std::endl;
             error = true;
         }
+        if( dual_pairs != cohomology_pairs ) {
+            std::cerr << "Error: dual and cohomology differ!" << std::endl;
+            error = true;
+        }
+
+        if( error ) return EXIT_FAILURE;
+        else std::cout << "All results are identical (as they should be)" << std::endl;
+    }
+
+    std::cout << "Testing persistence diagram ..." << std::endl;
+    {
+        phat::persistence_pairs twist_pairs;
+        phat::boundary_matrix< BitTree > twist_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_pairs< phat::twist_reduction >( twist_pairs, twist_boundary_matrix );
+
+        std::vector< double > filtration_values( boundary_matrix.get_num_cols() );
+        for( phat::index idx = 0; idx < boundary_matrix.get_num_cols(); idx++ )
+            filtration_values[ idx ] = 0.5 * idx;
+        phat::persistence_diagram diagram;
+        phat::boundary_matrix< BitTree > diagram_boundary_matrix = boundary_matrix;
+        phat::compute_persistence_diagram< phat::chunk_reduction >( diagram, diagram_boundary_matrix, filtration_values.data() );
+
+        phat::persistence_pairs diagram_pairs;
+        diagram.get_persistence_pairs( diagram_pairs );
+        if( twist_pairs != diagram_pairs ) {
+            std::cerr << "Error: twist and persistence diagram differ!" << std::endl;
+            error = true;
+        }
+        if( 2 * diagram_pairs.get_num_pairs() + ( diagram.get_num_intervals() - diagram_pairs.get_num_pairs() ) != boundary_matrix.get_num_cols() ) {
+            std::cerr << "Error: persistence diagram does not cover all cells!" << std::endl;
+            error = true;
+        }
+        for( phat::index idx = 0; idx < diagram.get_num_intervals(); idx++ ) {
+            const phat::index birth = diagram.get_birth( idx );
+            const phat::index death = diagram.get_death( idx );
+            if( diagram.get_dim( idx ) != boundary_matrix.get_dim( birth ) || ( death != -1 && boundary_matrix.get_dim( death ) != diagram.get_dim( idx ) + 1 )
+                || diagram.get_birth_value( idx ) != 0.5 * birth
+                || diagram.get_death_value( idx ) != ( diagram.is_essential( idx ) ? std::numeric_limits< double >::infinity() : 0.5 * death ) ) {
+                std::cerr << "Error: wrong interval in persistence diagram!" << std::endl;
+                error = true;
+                break;
+            }
+        }
 
         if( error ) return EXIT_FAILURE;
         else std::cout << "All results are identical (as they should be)" << std::endl;